@@ -0,0 +1,116 @@
+# Werner Dune engine check
+
+# This script checks that the kmc engine reproduces the statistics of the polling engine.
+# The two engines draw their random numbers in a different order, so their surfaces never
+# match slab for slab; what must match is the behaviour of the field. Both engines are run
+# from the same surface over a set of fixed seeds, and for each run the sand flux (trans_pass
+# in slab_log.csv) and the rms roughness (field_stats.csv) are averaged over the second half
+# of the run. The per-seed averages of the two engines are compared with Welch's t-test: the
+# check fails if |t| exceeds max_t for either metric (about a two-sided p of 0.01 at these
+# sample sizes).
+#
+# Usage (after building the core with 'make'):
+#     python3 check_engines.py          or          make check
+#
+# The runs are made in a temporary directory, which is removed afterwards.
+
+# ----------------------------------------------------------------------------------
+# Import modules
+import os, random, math, sys, shutil, subprocess, tempfile
+
+# ----------------------------------------------------------------------------------
+# Settings
+engines = ["polling", "kmc"]        # engines to compare, the first is the reference
+seeds = [1, 2, 3, 4, 5, 6, 7, 8]    # fixed seeds, one run per engine and seed
+rows = 100                          # size of the field
+cols = 100
+iterations = 100                    # iterations per run, the second half is averaged
+max_t = 3.0                         # largest accepted |t| of Welch's test
+
+core = os.path.join (os.path.dirname (os.path.abspath (sys.argv[0])), "wdune_core.exe")
+
+# ----------------------------------------------------------------------------------
+# Functions
+
+# write the starting surface (a random sheet of 2 to 5 slabs) and a flat basement
+def write_inputs (path):
+    field = random.Random (1)
+    surf = open (os.path.join (path, "surf.txt"), "w")
+    bsmt = open (os.path.join (path, "bsmt.txt"), "w")
+    for i in range (rows):
+        surf.write (" ".join ([str (field.randint (2, 5)) for j in range (cols)]) + "\n")
+        bsmt.write (" ".join (["0"] * cols) + "\n")
+    surf.close ()
+    bsmt.close ()
+
+# average a column of a csv log over the second half of the run
+def late_mean (file, column):
+    lines = open (file).read ().split ("\n")[1:]
+    values = [float (line.split (",")[column]) for line in lines if line != ""]
+    late = values[len (values) // 2:]
+    return sum (late) / len (late)
+
+# run one engine with one seed, return the late flux and roughness
+def run (path, engine, seed):
+    cfg = open (os.path.join (path, "run.cfg"), "w")
+    cfg.write ("iterations = %d\nwind = north\nrows = %d\ncols = %d\n" % (iterations, rows, cols))
+    cfg.write ("boundaries = periodic\nengine = %s\nseed = %d\n" % (engine, seed))
+    cfg.close ()
+    shutil.copy (os.path.join (path, "surf0.txt"), os.path.join (path, "surf.txt"))
+    status = subprocess.call ([core, "run.cfg"], cwd = path, stdout = open (os.devnull, "w"))
+    if status != 0:
+        print ("ERROR: %s RUN WITH SEED %d EXITED WITH %d" % (engine, seed, status))
+        sys.exit (1)
+    return (late_mean (os.path.join (path, "slab_log.csv"), 1),
+            late_mean (os.path.join (path, "field_stats.csv"), 2))
+
+# mean and sample variance of a list
+def mean_var (x):
+    m = sum (x) / len (x)
+    return m, sum ([(v - m) ** 2 for v in x]) / (len (x) - 1)
+
+# Welch's t statistic of two samples
+def welch_t (a, b):
+    ma, va = mean_var (a)
+    mb, vb = mean_var (b)
+    se = math.sqrt (va / len (a) + vb / len (b))
+    if se == 0.0:
+        return 0.0 if ma == mb else float ("inf")
+    return (ma - mb) / se
+
+# ----------------------------------------------------------------------------------
+# Main
+
+if not os.path.exists (core):
+    print ("ERROR: %s NOT FOUND, BUILD IT WITH make" % core)
+    sys.exit (1)
+
+path = tempfile.mkdtemp (prefix = "wdune_check_")
+write_inputs (path)
+shutil.move (os.path.join (path, "surf.txt"), os.path.join (path, "surf0.txt"))
+
+flux = {}
+rough = {}
+for engine in engines:
+    flux[engine] = []
+    rough[engine] = []
+    for seed in seeds:
+        f, r = run (path, engine, seed)
+        flux[engine].append (f)
+        rough[engine].append (r)
+shutil.rmtree (path)
+
+failed = False
+print ("%-10s %-10s %12s %12s %8s" % ("metric", "engine", "mean", "std", "t"))
+for name, data in (("flux", flux), ("roughness", rough)):
+    for engine in engines:
+        m, v = mean_var (data[engine])
+        t = welch_t (data[engine], data[engines[0]])
+        print ("%-10s %-10s %12.4f %12.4f %8.2f" % (name, engine, m, math.sqrt (v), t))
+        if abs (t) > max_t:
+            failed = True
+
+if failed:
+    print ("FAILED: the engines differ by more than |t| = %.1f" % max_t)
+    sys.exit (1)
+print ("PASSED: the engines agree within |t| = %.1f over %d seeds" % (max_t, len (seeds)))
@@ -46,28 +46,51 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 // include standard libraries
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <math.h>
 
 using namespace std;
 
 // include the program as header file
 #include "mersenne_twister.h"     		// include the random number generator: Mersenne Twister
+#include "wdune_random.hpp"       		// the same generator, made a block at a time
 #include "wdune_globals.hpp"      		// global variables
+#include "wdune_default_params.hpp"		// default parameters, the starting point for a configuration file
+#include "wdune_config.hpp"       		// configuration file reader and parameter checks
+#include "wdune_grids.hpp"        		// grid storage, in memory or mapped from backing files
+#include "wdune_basement.hpp"     		// compressed read only basement store
+#include "wdune_envelope.hpp"     		// lazy shadow queries along the wind lines
+#include "wdune_tiles.hpp"        		// tile activity tracking for the erosion sampler
 #include "wdune_analysis.hpp"	  		// analysis functions
+#include "wdune_domain.hpp"       		// strips of a domain split over ranks
 #include "wdune_functions.hpp"    		// IRF function definitions
+#include "wdune_prefetch.hpp"     		// prefetching of the polls ahead in the polling engine
+#include "wdune_supply.hpp"       		// sediment supply from source maps
+#include "wdune_wind.hpp"         		// time-varying wind schedule
+#include "wdune_exchange.hpp"     		// rank processes and the exchanges between them
+#include "wdune_branch.hpp"       		// continuation runs forked from a shared spin-up
+#include "wdune_cache.hpp"        		// checkpoints of spin-ups kept on disk and reused
 #include "wdune_irfs.hpp"         		// core functions, called by the IRF functions
 #include "wdune_acc.hpp"          		// accessory functions
-//#include "wdune_default_params.hpp"		// a basic default parameter file for debugging purposes
 
 int main(int nArgs, char *pszArgs[])
 {
     /*
-	Note: this program requires 11 arguments (space separated)
+	Note: this program requires 11 arguments (space separated), 12 with an oblique wind, or the
+	name of a configuration file (see wdune_config.hpp), optionally followed by --dry-run
 		Arguments:
         Number of iterations (integer)
-        Wind direction (integer one of 1 = north, 2 = South, 3 = east, 4 = west)
+        Wind direction (integer one of 1 = north, 2 = South, 3 = east, 4 = west, 5 = oblique)
         Deposition jump (integer)
         Probability of depositing on sand (double)
         Probability of depositing on no sand (double)
@@ -76,34 +99,76 @@ int main(int nArgs, char *pszArgs[])
         Number of columns (integer)
         Type of boundaries (integer, 1 = non-periodic, 2 = periodic, 3 = non-periodic EW,
                             4 = non-periodic NW)
-        New sand code (integer code to allow new sand: 2 digits: 1st: 1 = point, 2 = edge;
-            2nd = side (1 = north, 2 = South, 3 = east, 4 = west))
+        New sand code (integer code to allow new sand: 2 digits: 1st: 1 = point, 2 = edge,
+            3 = source map; 2nd = side (1 = north, 2 = South, 3 = east, 4 = west), 0 for source map)
         New sand slabs (number of slabs to add)
+        Wind azimuth (optional, double, degrees clockwise from north the wind is coming from,
+            only used with wind direction 5)
 
     Input files:
     1) 'surf.txt': integer space separated grid of surface slab heights
     2) 'bsmt.txt': integer space separated grid of non-erodible basement height
+    3) 'supply_map.txt': space separated grid of new sand source weights (new sand code 30 only)
+    4) 'supply_series.txt': lines of 'iteration slabs' giving the new sand rate through time
+        (new sand code 30 only, optional)
+    5) 'wind_schedule.txt': lines of 'direction duration depjump dropdist' replacing the fixed
+        wind arguments (optional)
+    6) 'steady_params.txt': steady state monitor settings, stops the run early once the field
+        is steady (optional, see wdune_analysis.hpp)
+    7) 'engine.txt': erosion sampler code (0 = polling, 1 = tile sampler, 2 = kinetic Monte Carlo,
+        optional)
+    8) 'backing_dir.txt': directory for memory mapped backing files of the grids, for domains
+        larger than RAM (optional, see wdune_grids.hpp)
+    9) 'branches.txt': lines of 'direction depjump dropdist newsandcode newsandslabs' for the
+        continuation runs forked from a spin-up (optional, see wdune_branch.hpp)
 
     Output files:
     1) 'surf.txt': integer space separated grid of output surface slab heights (overwrites input)
+    2) 'surf_bb.txt': the same for branch b of a spin-up (b = 1 to branches, surf.txt holds the
+        spun-up surface)
+    4) checkpoints in the cache directory, if there is one (see wdune_cache.hpp)
     */
-	numIterations = atoi (pszArgs[1]);
-	wdir = atoi (pszArgs[2]);
-	depjump = atoi (pszArgs[3]);
-	psand = atof (pszArgs[4]);
-	pnosand = atof (pszArgs[5]);
-	dropdist = atof (pszArgs[6]);
-	nrows = atoi (pszArgs[7]);
-	ncols = atoi (pszArgs[8]);
-	bound_type = atoi (pszArgs[9]);
-	newSandCode = atoi (pszArgs[10]);
-	newSandSlabs = atoi (pszArgs[11]);
+	bool dry_run = (nArgs == 3 && strcmp (pszArgs[2], "--dry-run") == 0);
+	if (nArgs == 12 || nArgs == 13)		// the argument list
+	{
+		numIterations = atoi (pszArgs[1]);
+		wdir = atoi (pszArgs[2]);
+		depjump = atoi (pszArgs[3]);
+		psand = atof (pszArgs[4]);
+		pnosand = atof (pszArgs[5]);
+		dropdist = atof (pszArgs[6]);
+		nrows = atoi (pszArgs[7]);
+		ncols = atoi (pszArgs[8]);
+		bound_type = atoi (pszArgs[9]);
+		newSandCode = atoi (pszArgs[10]);
+		newSandSlabs = atoi (pszArgs[11]);
+		if (nArgs > 12) { wind_azimuth = atof (pszArgs[12]); }
+		read_engine_file ();
+		read_analysis_files ();
+	}
+	else if (nArgs == 2 || dry_run)		// a configuration file
+	{
+		read_config (pszArgs[1]);
+		apply_config ();
+	}
+	else
+	{
+		cout << "ERROR: EXPECTED 11 OR 12 ARGUMENTS OR A CONFIGURATION FILE" << endl;
+		exit (12);
+	}
+	validate_params ();		// stop here if any parameter is wrong
+	if (dry_run)
+	{
+		print_config ();
+		print_memory_estimate ();
+		return 0;
+	}
 	
     // A) initialize
     init_wdune();
 
     // B) loop
-    while (t < numIterations)
+    while (t < numIterations && !stop_run)
     {
         // run, called every timestep
         run_wdune();
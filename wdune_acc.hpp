@@ -47,7 +47,7 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 
 void timePrinter()     // time printer: prints percentages of time completed
 {
-    if (t % (numIterations/10) == 0)
+    if (dom_rank == 0 && (branch_id == 1 || !branch_forked) && (numIterations < 10 || t % (numIterations/10) == 0))
     {
         time_t nowTime;
         struct tm * timeString;
@@ -57,3 +57,69 @@ void timePrinter()     // time printer: prints percentages of time completed
         cout << percentDone << "% complete, Time: " << asctime(timeString);
     }
 }
+
+bool feature_on(const char * key, const char * file)     // is an optional feature switched on, by key or by parameter file
+{
+    FILE *pFile;
+    if (config_has (key))
+    {
+        return true;
+    }
+    pFile = fopen (file, "r");
+    if (pFile != NULL)
+    {
+        fclose (pFile);
+        return true;
+    }
+    return false;
+}
+
+void print_memory_estimate()    // estimate the memory a run will take, from the parameters alone
+{
+    double cells = (double)nrows * ncols;
+    double mb = 1024.0 * 1024.0;
+    double grids = cells * (sizeof (int) + ((shadow_mode == 0) ? sizeof (double) : sizeof (int)));   // surface and shadow (or its trees)
+    double bsmt_max = cells * sizeof (int);                         // basement, if no block is flat
+    double other = 0.0;
+    bool mapped = feature_on ("backing_dir", "backing_dir.txt");
+
+    if (engine == 1 || engine == 2)
+    {
+        other = other + cells / 8.0;                                // tile sampler bits
+    }
+    if (newSandCode == 30)
+    {
+        other = other + cells * 32.0;                               // source map and alias table, at most
+    }
+    if (morph_on)
+    {
+        other = other + cells * (sizeof (int) + sizeof (bool));     // union-find and crest cells
+    }
+    if (spectrum_on)
+    {
+        other = other + (double)nrows * (ncols / 2 + 1) * 2 * sizeof (double);     // half spectrum
+    }
+
+    cout << "Memory estimate:" << endl;
+    cout << "    Surface and shadow grids = " << grids / mb << " MB"
+        << (mapped ? " (mapped from backing files)" : "") << endl;
+    cout << "    Basement = 0 to " << bsmt_max / mb << " MB (constant to nowhere flat)" << endl;
+    cout << "    Sampler and analysis = " << other / mb << " MB" << endl;
+    if (nranks > 1)
+    {
+        cout << "    Ranks = " << nranks << ", each with its own copy of the above, plus "
+            << (cells * sizeof (int) + (double)nranks * nranks * dom_mailbox * sizeof (dom_msg)) / mb
+            << " MB shared" << endl;
+    }
+    if (nbranches > 0)
+    {
+        cout << "    Branches = " << nbranches << " forked at iteration " << branch_at
+            << ", sharing the above until they write to it, up to a copy each" << endl;
+    }
+    if (config_has ("cache_dir"))
+    {
+        cout << "    Checkpoints = " << (cells * sizeof (int) + 2.0 * N * sizeof (unsigned int)) / mb
+            << " MB each on disk, up to " << cache_mb << " MB in " << config_str ("cache_dir") << endl;
+    }
+    cout << "    Total = " << (grids + other) / mb << " to " << (grids + bsmt_max + other) / mb << " MB" << endl;
+}
@@ -47,6 +47,9 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 // Object definitions for analysis functions are first, followed by generic wrapper functions
 // NOTE: some analysis functions require deep integration with the model, so there may be 
 
+const int max_gates = 32;			// maximum number of slablogger gates (including the downwind edge)
+const int slab_buf_size = 65536;	// size of the slablogger output buffer (characters)
+
 class slablogger {
 	/*
 	The slablogger records the dune field wide sediment flux through a gate at the downwind edge
@@ -56,27 +59,44 @@ class slablogger {
 	and slabs passing through the gate in avalanche separately.
 	
 	The flux is in units of number of slabs per iteration (assuming the record method is called
-	every iteration).	
+	every iteration).
+	
+	Extra gates (transects across the wind) can be added in 'slab_gates.txt', one position per
+	line. A gate at position g sits between row (or column, for east and west winds) g - 1 and g;
+	the downwind edge is the gate at position 0. Each gate gets its own pair of columns in the log,
+	and a running total per row or column crossing the gate is written to 'slab_lines.csv' at the
+	end. The log also carries the mass balance: slabs added by new sand, slabs blown out, and the
+	sand in the model space.
+	
+	Records are written into a fixed buffer that goes to 'slab_log.csv' whenever it fills, so the
+	memory use does not grow with the run and a run that dies only loses the last buffer.
 	*/
 	
 	public:
-		int trans_log;			// the number of slabs that pass the downwind edge in transport
-		int avi_log;			// the number of slabs that pass the downwind edge in avalanche
-		
-		int * iter;				// Pointer leads for initialized arrays
-		int * trans;
-		int * avi;
-		
-		// flux arrays are used to know when a slab is deposited off the edge of the model space
-		// 0 = sediment in movement isn't contributing to the slablogger flux
-		// 1 = sediment in movement is contributing to the slablogger flux (passing downwind over edge)
-		// -1 = sediment in movement is contributing negatively to the slablogger flux (passing upwind over edge)
-		int * i_n_flux;			// Pointer leads for flux arrays
-		int * i_s_flux;
-		int * j_e_flux;
-		int * j_w_flux;
-		int * i_dp_flux;
-		int * j_dp_flux;
+		int ngates;				// number of gates, gate 0 is the downwind edge
+		int gate_pos[max_gates];	// gate positions along the wind axis
+		int trans_log[max_gates];	// the number of slabs that pass each gate in transport
+		int avi_log[max_gates];	// the number of slabs that pass each gate in avalanche
+		bool gates_on_rows;		// gates lie between rows (north and south winds), else columns
+		long long mass0;		// sand in the model space at the start
+		
+		int * line_trans;		// running totals of slabs passing each gate, per line across the wind
+		int * line_avi;
+		
+		// gate arrays are bit masks of the gates a slab in movement passes, one bit per gate
+		// (bit 0 = downwind edge). The sign arrays give the direction of each avalanche move:
+		// 1 = passing downwind over the gate, -1 = passing upwind, 0 = the move passes no gates
+		unsigned int * i_n_gate;	// Pointer leads for gate arrays
+		unsigned int * i_s_gate;
+		unsigned int * j_e_gate;
+		unsigned int * j_w_gate;
+		unsigned int * i_dp_gate;
+		unsigned int * j_dp_gate;
+		int avi_sign[5];		// indexed by avalanche direction: 1 = north, 2 = South, 3 = east, 4 = west
+		
+		FILE * pSlabLog;		// the log file, open through the whole run
+		char buf[slab_buf_size];	// output buffer
+		int buf_used;			// characters in the output buffer
 		
 		//  CONSTRUCTOR
 		slablogger() {
@@ -85,85 +105,165 @@ class slablogger {
 		
 		void init() {
 			// INITIALIZE the slablogger object: called at runtime
-			trans_log = 0;
-			avi_log = 0;
+			FILE *pGates;
+			int pos;
+			int nlines = (nrows > ncols) ? nrows : ncols;
+			
+			// read any extra gates
+			ngates = 1;
+			gate_pos[0] = 0;
+			pGates = fopen ("slab_gates.txt", "r");
+			if (pGates != NULL) {
+				while (ngates < max_gates && fscanf (pGates, "%d", &pos) == 1) {
+					gate_pos[ngates] = pos;
+					ngates++;
+				}
+				fclose (pGates);
+			}
 			
 			// allocate new memory for the slablogger variables
 			try {
-				iter = new int [numIterations];
-				trans = new int [numIterations];
-				avi = new int [numIterations];
-				i_n_flux = new int [nrows];
-				i_s_flux = new int [nrows];
-				j_e_flux = new int [ncols];
-				j_w_flux = new int [ncols];
-				i_dp_flux = new int [nrows];
-				j_dp_flux = new int [ncols];				
-				
+				line_trans = new int [max_gates * nlines];
+				line_avi = new int [max_gates * nlines];
+				i_n_gate = new unsigned int [nrows];
+				i_s_gate = new unsigned int [nrows];
+				j_e_gate = new unsigned int [ncols];
+				j_w_gate = new unsigned int [ncols];
+				i_dp_gate = new unsigned int [nrows];
+				j_dp_gate = new unsigned int [ncols];
 			}
 			catch(...) {
 				cout << "CANNOT ALLOCATE MEMORY!!" << endl;
 				exit (10);
 			}
+			for (int ff = 0; ff < max_gates * nlines; ff++) {
+				line_trans[ff] = 0;
+				line_avi[ff] = 0;
+			}
+			for (int g = 0; g < max_gates; g++) {
+				trans_log[g] = 0;
+				avi_log[g] = 0;
+			}
+			
+			// sand in the model space at the start, for the mass balance (less the slabs that came in
+			// and went out before a checkpoint the run was restored from, see wdune_cache.hpp)
+			mass0 = slabs_out - slabs_in;
+			for (int i = 0; i < nrows; i++) {
+				for (int j = 0; j < ncols; j++) {
+					mass0 = mass0 + surf[i][j] - bsmt_at(i, j);
+				}
+			}
+			
+			set_fluxes();
+			if (nranks > 1) {
+				return;			// a rank would only log its own strip: no file (see wdune_exchange.hpp)
+			}
+			
+			// open the log and write out a header
+			pSlabLog = fopen ("slab_log.csv", "w");
+			buf_used = 0;
+			buf_used += sprintf (buf + buf_used, "%s", "iteration,trans_pass,avi_pass");
+			for (int g = 1; g < ngates; g++) {
+				buf_used += sprintf (buf + buf_used, ",trans_pass_%i,avi_pass_%i", gate_pos[g], gate_pos[g]);
+			}
+			buf_used += sprintf (buf + buf_used, "%s", ",slabs_in,slabs_out,mass\n");
+		}
+		
+		// Method to find the gates crossed stepping from boundary position 'from' to 'to' along the
+		// wind axis (n cells long), 'from' and 'to' not wrapped
+		unsigned int crossed(int from, int to, int n) {
+			unsigned int mask = 0;
+			int lo = (from < to) ? from : to;
+			int hi = (from < to) ? to : from;
+			for (int g = 0; g < ngates; g++) {
+				// check the gate and its periodic images
+				for (int p = gate_pos[g] - n; p <= gate_pos[g] + n; p += n) {
+					if (p > lo && p <= hi) {
+						mask = mask | (1u << g);
+					}
+				}
+			}
+			return mask;
+		}
+		
+		void set_fluxes() {
+			// SET the gate arrays for the present wind direction and deposition lookups:
+			// called at initialization and again whenever the wind changes
 			
-			// populating the flux variables
 			// Set everything to 0 to start things out
 			for (int ff = 0; ff < nrows; ff++) {
-				i_n_flux[ff] = 0;
-				i_s_flux[ff] = 0;
-				i_dp_flux[ff] = 0;			
+				i_n_gate[ff] = 0;
+				i_s_gate[ff] = 0;
+				i_dp_gate[ff] = 0;
 			}
-			
 			for (int ff = 0; ff < ncols; ff++) {
-				j_e_flux[ff] = 0;
-				j_w_flux[ff] = 0;
-				j_dp_flux[ff] = 0;			
+				j_e_gate[ff] = 0;
+				j_w_gate[ff] = 0;
+				j_dp_gate[ff] = 0;
+			}
+			for (int d = 0; d < 5; d++) {
+				avi_sign[d] = 0;
 			}
 			
-			// Flux passing over the downwind edge will contribute positively or negatively
+			// Flux passing over a gate will contribute positively or negatively
 			// to the slablogger measured flux
 			// We make use of the wind direction global variable 'wdir' where:
 			// 1 = north, 2 = South, 3 = east, 4 = west (direction wind is coming from)
 			// to define whether the flux adds negatively or positively to the total flux
-			if (wdir == 1) {
-				i_n_flux[0] = -1;
-				i_s_flux[nrows - 1] = 1;
+			// Oblique winds (5) use the gates of the cardinal direction sharing their major axis
+			int wd = (wdir == 5) ? obl_cardinal : wdir;
+			if (wd == 1) {
+				avi_sign[1] = -1;
+				avi_sign[2] = 1;
 			}
-			else if (wdir == 2) {
-				i_n_flux[0] = 1;
-				i_s_flux[nrows - 1] = -1;			
+			else if (wd == 2) {
+				avi_sign[1] = 1;
+				avi_sign[2] = -1;
 			}
-			else if (wdir == 3) {
-				j_e_flux[0] = 1;
-				j_w_flux[ncols - 1] = -1;			
+			else if (wd == 3) {
+				avi_sign[3] = -1;
+				avi_sign[4] = 1;
 			}
-			else if (wdir == 4) {
-				j_e_flux[0] = - 1;
-				j_w_flux[ncols - 1] = 1;
+			else if (wd == 4) {
+				avi_sign[3] = 1;
+				avi_sign[4] = -1;
 			}
 			else {
 				cout << "ERROR WITH WIND DIRECTION" << endl;
 				exit (5);
 			}
+			gates_on_rows = (wd == 1 || wd == 2);
 			
-			// The deposition lookups are a bit more complicated
-			// we can look for situations where the difference between the present coordinate
-			// and the deposit coordinate designated by the deposit lookups is greater than
-			// or less than 1 - we know it is referring to a coordinate across an edge
-			for (int ff = 0; ff < nrows; ff++) {
-				if (i_dp[ff] == i_toxic) {
-					i_dp_flux[ff] = 1;
-				}
-				if ((i_dp[ff] - ff) > 1 || (i_dp[ff] - ff) < -1) {
-					i_dp_flux[ff] = 1;
+			// The avalanche moves: moving one cell across a boundary position, if the neighbour lookup
+			// actually moves the slab (mirrored edges do not). Moving north from row i crosses position i,
+			// moving south crosses position i + 1 (the same for west and east along the columns).
+			// The transport moves: a deposition jump along the wind axis crosses every position it passes.
+			if (gates_on_rows) {
+				for (int ff = 0; ff < nrows; ff++) {
+					if (i_n[ff] != ff) { i_n_gate[ff] = crossed(ff - 1, ff, nrows); }
+					if (i_s[ff] != ff) { i_s_gate[ff] = crossed(ff, ff + 1, nrows); }
+					if (wd == 1) { i_dp_gate[ff] = crossed(ff, ff + depjump, nrows); }
+					if (wd == 2) { i_dp_gate[ff] = crossed(ff - depjump, ff, nrows); }
 				}
 			}
-			for (int ff = 0; ff < ncols; ff++) {
-				if (j_dp[ff] == j_toxic) {
-					j_dp_flux[ff] = 1;
+			else {
+				for (int ff = 0; ff < ncols; ff++) {
+					if (j_w[ff] != ff) { j_w_gate[ff] = crossed(ff - 1, ff, ncols); }
+					if (j_e[ff] != ff) { j_e_gate[ff] = crossed(ff, ff + 1, ncols); }
+					if (wd == 4) { j_dp_gate[ff] = crossed(ff, ff + depjump, ncols); }
+					if (wd == 3) { j_dp_gate[ff] = crossed(ff - depjump, ff, ncols); }
 				}
-				if ((j_dp[ff] - ff) > 1 || (j_dp[ff] - ff) < -1) {
-					j_dp_flux[ff] = 1;
+			}
+		}
+		
+		// Method to add up the gates passed by a slab in movement
+		void count(unsigned int mask, int sign, int i, int j, int * log, int * line) {
+			int n = gates_on_rows ? j : i;		// the line across the wind
+			int nlines = (nrows > ncols) ? nrows : ncols;
+			for (int g = 0; g < ngates; g++) {
+				if (mask & (1u << g)) {
+					log[g] = log[g] + sign;
+					line[g * nlines + n] = line[g * nlines + n] + sign;
 				}
 			}
 		}
@@ -172,8 +272,9 @@ class slablogger {
 		void increment_trans(int i_trans, int j_trans) {
 			// Arguments are the coordinates of the site just before the focal
 			// coordinates are moved and the slab is assessed for deposition
-			if (i_dp_flux[i_trans] || j_dp_flux[j_trans]) {
-				trans_log++;	// the slab is about to move across a model boundary!
+			unsigned int mask = i_dp_gate[i_trans] | j_dp_gate[j_trans];
+			if (mask) {
+				count(mask, 1, i_trans, j_trans, trans_log, line_trans);	// the slab is about to move across a gate!
 			}
 		}
 		
@@ -187,69 +288,913 @@ class slablogger {
 			// avalanched down
 			
 			// Avalanche direction:  1 = north, 2 = South, 3 = east, 4 = west
+			unsigned int mask = 0;
 			if (avi_dir == 1) {
-				avi_log = avi_log + i_n_flux[i_avi];
+				mask = i_n_gate[i_avi];
 			}
 			if (avi_dir == 2) {
-				avi_log = avi_log + i_s_flux[i_avi];
+				mask = i_s_gate[i_avi];
 			}
 			if (avi_dir == 3) {
-				avi_log = avi_log + j_e_flux[j_avi];
+				mask = j_e_gate[j_avi];
 			}
 			if (avi_dir == 4) {
-				avi_log = avi_log + j_w_flux[j_avi];
+				mask = j_w_gate[j_avi];
 			}
+			if (mask) {
+				count(mask, avi_sign[avi_dir], i_avi, j_avi, avi_log, line_avi);
+			}
+		}
+		
+		// Method to write the buffer out to the log
+		void flush() {
+			fwrite (buf, 1, buf_used, pSlabLog);
+			fflush (pSlabLog);
+			buf_used = 0;
 		}
 		
-		// Method to record the variables to the internal array at each iteration end
+		// Method to record the variables to the output buffer at each iteration end
 		void record() {
-			iter[t] = t;
-			trans[t] = trans_log;
-			avi[t] = avi_log;
+			buf_used += sprintf (buf + buf_used, "%i,%i,%i", t, trans_log[0], avi_log[0]);
+			for (int g = 1; g < ngates; g++) {
+				buf_used += sprintf (buf + buf_used, ",%i,%i", trans_log[g], avi_log[g]);
+			}
+			buf_used += sprintf (buf + buf_used, ",%i,%i,%lli\n", slabs_in, slabs_out,
+				mass0 + slabs_in - slabs_out);
 			// reset the variables
-			trans_log = 0;
-			avi_log = 0;
+			for (int g = 0; g < ngates; g++) {
+				trans_log[g] = 0;
+				avi_log[g] = 0;
+			}
+			// write out the buffer when there may not be room for another record
+			if (buf_used > slab_buf_size - 32 * (max_gates + 2)) {
+				flush();
+			}
 		}
 		
 		// Method to finalize
 		void finalize() {
-			// Open up a file and record out the slab log to a csv file
-			FILE *pSlabLog;
-			pSlabLog = fopen ("slab_log.csv", "w");
-			// write out a header
-			fprintf (pSlabLog, "%s", "iteration,trans_pass,avi_pass\n");
-			
-			// write out the data
-			for (int w = 0; w < numIterations; w++) {
-				fprintf (pSlabLog, "%i,", iter[w]);
-				fprintf (pSlabLog, "%i,", trans[w]);
-				fprintf (pSlabLog, "%i", avi[w]);
-				fprintf (pSlabLog, "%s", "\n");			
-			}
-					
+			// write out what is left of the slab log
+			flush();
 			fclose (pSlabLog);
+			
+			// write out the per line totals
+			FILE *pSlabLines;
+			int nlines = (nrows > ncols) ? nrows : ncols;
+			int nl = gates_on_rows ? ncols : nrows;
+			pSlabLines = fopen ("slab_lines.csv", "w");
+			fprintf (pSlabLines, "%s", "gate,line,trans_pass,avi_pass\n");
+			for (int g = 0; g < ngates; g++) {
+				for (int n = 0; n < nl; n++) {
+					fprintf (pSlabLines, "%i,%i,%i,%i\n", gate_pos[g], n,
+						line_trans[g * nlines + n], line_avi[g * nlines + n]);
+				}
+			}
+			fclose (pSlabLines);
+		}
+};
+
+const int max_hist = 1024;			// number of height histogram bins (heights 0 to max_hist - 1)
+
+class fieldstats {
+	/*
+	The fieldstats object keeps running totals of the surface: sum of heights, sum of squared
+	heights, number of cells with sand above the basement and a histogram of heights. Every
+	change to the surface is one slab up or down at one cell and passes through the avalanche
+	functions, which call update with the heights before and after, so the totals stay exact
+	without ever passing over the grid after initialization.
+	
+	Mean height, RMS roughness (standard deviation of height), sand cover fraction and the
+	number of exposed basement cells are written to 'field_stats.csv' every iteration through
+	a fixed buffer (as with the slablogger). The height histogram is written to 'height_hist.csv'
+	at the end. Heights outside the histogram range are counted in the first or last bin.
+	*/
+	
+	public:
+		long long sum_h;		// sum of heights
+		long long sum_h2;		// sum of squared heights
+		int sand_cells;			// number of cells with the surface above the basement
+		int hist[max_hist];		// height histogram
+		
+		FILE * pStats;			// the statistics file, open through the whole run
+		char buf[slab_buf_size];	// output buffer
+		int buf_used;			// characters in the output buffer
+		
+		//  CONSTRUCTOR
+		fieldstats() {
+
+		}
+		
+		// Method to find the histogram bin of a height
+		int bin(int h) {
+			if (h < 0) { return 0; }
+			if (h >= max_hist) { return max_hist - 1; }
+			return h;
+		}
+		
+		void init() {
+			// INITIALIZE the fieldstats object: one pass over the grid at runtime
+			sum_h = 0;
+			sum_h2 = 0;
+			sand_cells = 0;
+			for (int b = 0; b < max_hist; b++) {
+				hist[b] = 0;
+			}
+			for (int i = 0; i < nrows; i++) {
+				for (int j = 0; j < ncols; j++) {
+					sum_h = sum_h + surf[i][j];
+					sum_h2 = sum_h2 + (long long)surf[i][j] * surf[i][j];
+					if (above_bsmt(i, j, surf[i][j])) {
+						sand_cells++;
+					}
+					hist[bin(surf[i][j])]++;
+				}
+			}
+			
+			if (nranks > 1) {
+				return;			// a rank would only see its own strip: no file (see wdune_exchange.hpp)
+			}
+			pStats = fopen ("field_stats.csv", "w");
+			buf_used = sprintf (buf, "%s", "iteration,mean_height,rms_roughness,sand_cover,exposed_basement\n");
+		}
+		
+		// Method to update the totals for one cell changing height from h_old to h_new over basement b
+		void update(int h_old, int h_new, int b) {
+			sum_h = sum_h + (h_new - h_old);
+			sum_h2 = sum_h2 + (long long)h_new * h_new - (long long)h_old * h_old;
+			sand_cells = sand_cells + (h_new > b) - (h_old > b);
+			hist[bin(h_old)]--;
+			hist[bin(h_new)]++;
+		}
+		
+		// Methods to report the statistics
+		double mean() {
+			return (double)sum_h / ((double)nrows * ncols);
+		}
+		
+		double roughness() {
+			double m = mean();
+			double var = (double)sum_h2 / ((double)nrows * ncols) - m * m;
+			return (var > 0.0) ? sqrt (var) : 0.0;
+		}
+		
+		double cover() {
+			return (double)sand_cells / ((double)nrows * ncols);
+		}
+		
+		// Method to record the statistics to the output buffer at each iteration end
+		void record() {
+			buf_used += sprintf (buf + buf_used, "%i,%.6f,%.6f,%.6f,%i\n", t, mean(), roughness(),
+				cover(), nrows * ncols - sand_cells);
+			if (buf_used > slab_buf_size - 256) {
+				fwrite (buf, 1, buf_used, pStats);
+				fflush (pStats);
+				buf_used = 0;
+			}
+		}
+		
+		// Method to finalize
+		void finalize() {
+			fwrite (buf, 1, buf_used, pStats);
+			fclose (pStats);
+			
+			// write out the height histogram
+			FILE *pHist;
+			pHist = fopen ("height_hist.csv", "w");
+			fprintf (pHist, "%s", "height,cells\n");
+			for (int b = 0; b < max_hist; b++) {
+				if (hist[b] > 0) {
+					fprintf (pHist, "%i,%i\n", b, hist[b]);
+				}
+			}
+			fclose (pHist);
+		}
+};
+
+const int steady_metrics = 3;		// metrics watched by the steady state monitor
+
+class steadymonitor {
+	/*
+	The steady state monitor watches three cheap metrics every iteration: the slablogger flux
+	through the downwind edge (transport plus avalanche), the RMS roughness and the sand cover
+	fraction. It keeps the last two windows of each metric in a ring and running sums of each
+	window, so the window means and variances cost O(1) per iteration.
+	
+	A metric is steady when the means of the two windows differ by no more than its relative
+	tolerance (times the older mean). When every metric has been steady for the set number of
+	consecutive checks (one check per window), the run is stopped and finalized early. The
+	reason the run stopped is written to 'steady_state.txt'.
+	
+	The monitor is switched on by 'steady_params.txt' (or steady_window in the configuration file):
+		window (iterations), flux tolerance, roughness tolerance, cover tolerance, checks
+	A negative tolerance leaves that metric out.
+	*/
+	
+	public:
+		bool active;			// is the monitor switched on
+		int window;				// window length (iterations)
+		double tol[steady_metrics];	// relative tolerances
+		int checks;				// consecutive steady checks needed to stop
+		int steady_count;		// consecutive steady checks so far
+		int nsamples;			// samples taken
+		double * ring;			// last two windows of each metric (2 * window per metric)
+		double sum_old[steady_metrics], sum2_old[steady_metrics];	// running sums, older window
+		double sum_new[steady_metrics], sum2_new[steady_metrics];	// running sums, newer window
+		
+		//  CONSTRUCTOR
+		steadymonitor() {
+			active = false;
+		}
+		
+		void init() {
+			// INITIALIZE the steady state monitor, if it is switched on (settings checked in validate_params)
+			if (!steady_on) {
+				return;
+			}
+			window = steady_window;
+			tol[0] = steady_tol[0]; tol[1] = steady_tol[1]; tol[2] = steady_tol[2];
+			checks = steady_checks;
+			
+			try {
+				ring = new double [2 * window * steady_metrics];
+			}
+			catch(...) {
+				cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+				exit (10);
+			}
+			for (int k = 0; k < steady_metrics; k++) {
+				sum_old[k] = 0.0; sum2_old[k] = 0.0;
+				sum_new[k] = 0.0; sum2_new[k] = 0.0;
+			}
+			active = true;
+			steady_count = 0;
+			nsamples = 0;
+			cout << "Steady state monitor: window " << window << ", tolerances " << tol[0] << " "
+				<< tol[1] << " " << tol[2] << ", checks " << checks << endl;
+		}
+		
+		// Method to get the mean and variance of a window
+		double win_mean(double sum) {
+			return sum / window;
+		}
+		
+		double win_var(double sum, double sum2) {
+			double m = sum / window;
+			double v = sum2 / window - m * m;
+			return (v > 0.0) ? v : 0.0;
+		}
+		
+		// Method to take the samples at the end of an iteration, returns true when steady
+		bool sample(double flux, double rough, double cov) {
+			double x[steady_metrics] = {flux, rough, cov};
+			int slot = nsamples % (2 * window);			// slot of the sample leaving the older window
+			int mid = (nsamples + window) % (2 * window);	// slot of the sample moving to the older window
+			bool steady = true;
+			
+			if (!active) {
+				return false;
+			}
+			for (int k = 0; k < steady_metrics; k++) {
+				double * r = ring + k * 2 * window;
+				if (nsamples >= 2 * window) {			// drop the oldest sample
+					sum_old[k] -= r[slot]; sum2_old[k] -= r[slot] * r[slot];
+				}
+				if (nsamples >= window) {				// move a sample from the newer window to the older one
+					sum_new[k] -= r[mid]; sum2_new[k] -= r[mid] * r[mid];
+					sum_old[k] += r[mid]; sum2_old[k] += r[mid] * r[mid];
+				}
+				r[slot] = x[k];
+				sum_new[k] += x[k]; sum2_new[k] += x[k] * x[k];
+			}
+			nsamples++;
+			
+			// check once per window, when both windows are full
+			if (nsamples < 2 * window || nsamples % window != 0) {
+				return false;
+			}
+			for (int k = 0; k < steady_metrics; k++) {
+				if (tol[k] >= 0.0 &&
+					fabs (win_mean(sum_new[k]) - win_mean(sum_old[k])) > tol[k] * fabs (win_mean(sum_old[k]))) {
+					steady = false;
+				}
+			}
+			steady_count = steady ? steady_count + 1 : 0;
+			return (steady_count >= checks);
+		}
+		
+		// Method to finalize: write out why the run stopped
+		void finalize() {
+			if (!active) {
+				return;
+			}
+			const char * names[steady_metrics] = {"flux", "roughness", "cover"};
+			FILE *pOut;
+			pOut = fopen ("steady_state.txt", "w");
+			if (steady_count >= checks) {
+				fprintf (pOut, "stopped at iteration %i: steady state for %i checks\n", t, steady_count);
+				cout << "Steady state reached, run stopped at iteration " << t << endl;
+			}
+			else {
+				fprintf (pOut, "ran to iteration %i: no steady state (%i steady checks)\n", t, steady_count);
+			}
+			if (nsamples >= 2 * window) {
+				for (int k = 0; k < steady_metrics; k++) {
+					fprintf (pOut, "%s: mean %.6f (previous window %.6f), variance %.6f, tolerance %.6f\n", names[k],
+						win_mean(sum_new[k]), win_mean(sum_old[k]), win_var(sum_new[k], sum2_new[k]), tol[k]);
+				}
+			}
+			fclose (pOut);
+		}
+};
+
+class morphology {
+	/*
+	The morphology object measures the dune field every K iterations without writing out grids:
+	
+	Dunes: cells higher than the field mean height plus a threshold (slabs) are dune cells,
+	and connected groups of them (4 neighbours, across periodic edges) are dunes. They are
+	labelled with union-find in a single raster pass: each dune cell is joined to its north and
+	west neighbours (the neighbour lookups handle periodic edges), with path halving keeping
+	the trees flat. The parent array is allocated once and reused.
+	
+	Crests: a crest cell is the brink of a slip face, where the drop to the downwind neighbour
+	is at the avalanche threshold but the drop into the cell from upwind is not. Crest cells are
+	labelled the same way (8 neighbours) into crest lines. A crest cell with one crest neighbour
+	is a crest end (a defect), and the defect density is crest ends per crest cell.
+	
+	Crest spacing: the mean gap between successive crest cells along the wind lines.
+	
+	The results go to 'morphology.csv'. The object is switched on by 'morph_params.txt' (or morph_interval in the
+	configuration file):
+		interval (iterations), dune threshold (slabs above mean height)
+	*/
+	
+	public:
+		bool active;			// is the object switched on
+		int interval;			// iterations between measurements
+		int dune_thresh;		// dune cells are higher than the mean plus this
+		int * parent;			// union-find parent of each cell (-1 = not in the set)
+		bool * crest;			// crest cells
+		FILE * pMorph;			// output file
+		
+		//  CONSTRUCTOR
+		morphology() {
+			active = false;
+		}
+		
+		void init() {
+			// INITIALIZE the morphology object, if it is switched on (settings checked in validate_params)
+			if (!morph_on) {
+				return;
+			}
+			interval = morph_interval;
+			dune_thresh = morph_threshold;
+			try {
+				parent = new int [nrows * ncols];
+				crest = new bool [nrows * ncols];
+			}
+			catch(...) {
+				cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+				exit (10);
+			}
+			pMorph = fopen ("morphology.csv", "w");
+			fprintf (pMorph, "%s", "iteration,dunes,mean_dune_area,crest_cells,crest_lines,defect_density,crest_spacing\n");
+			active = true;
+		}
+		
+		// Method to find the root of a cell, halving the path on the way
+		int find(int x) {
+			while (parent[x] != x) {
+				parent[x] = parent[parent[x]];
+				x = parent[x];
+			}
+			return x;
+		}
+		
+		// Method to join the sets of two cells (the lower index becomes the root)
+		void join(int a, int b) {
+			a = find(a);
+			b = find(b);
+			if (a < b) { parent[b] = a; }
+			if (b < a) { parent[a] = b; }
+		}
+		
+		// Method to count the sets after labelling
+		int count_sets() {
+			int n = 0;
+			for (int x = 0; x < nrows * ncols; x++) {
+				if (parent[x] == x) {
+					n++;
+				}
+			}
+			return n;
+		}
+		
+		// Method to get the downwind neighbour of a cell
+		void downwind(int i, int j, int wd, int &i_d, int &j_d) {
+			i_d = i; j_d = j;
+			if (wd == 1) { i_d = i_s[i]; }
+			if (wd == 2) { i_d = i_n[i]; }
+			if (wd == 3) { j_d = j_w[j]; }
+			if (wd == 4) { j_d = j_e[j]; }
+		}
+		
+		// Method to measure the field
+		void measure(double mean_height) {
+			int wd = (wdir == 5) ? obl_cardinal : wdir;
+			int level = (int)floor (mean_height) + dune_thresh;
+			int x, i_d, j_d, i_u, j_u, dune_cells, dunes, crest_cells, crest_lines, crest_ends, nb;
+			long long gap_sum = 0;
+			int gaps = 0;
+			
+			// dunes: one raster pass of union-find, joining each dune cell to its north and west neighbours
+			dune_cells = 0;
+			for (int i = 0; i < nrows; i++) {
+				for (int j = 0; j < ncols; j++) {
+					x = i * ncols + j;
+					if (surf[i][j] > level) {
+						parent[x] = x;
+						dune_cells++;
+						if (i > 0 && parent[x - ncols] >= 0) {
+							join(x, x - ncols);
+						}
+						if (j > 0 && parent[x - 1] >= 0) {
+							join(x, x - 1);
+						}
+					}
+					else {
+						parent[x] = -1;
+					}
+				}
+			}
+			// then across the periodic edges, where the neighbours come later in the raster
+			if (i_n[0] != 0) {
+				for (int j = 0; j < ncols; j++) {
+					if (parent[j] >= 0 && parent[i_n[0] * ncols + j] >= 0) {
+						join(j, i_n[0] * ncols + j);
+					}
+				}
+			}
+			if (j_w[0] != 0) {
+				for (int i = 0; i < nrows; i++) {
+					if (parent[i * ncols] >= 0 && parent[i * ncols + j_w[0]] >= 0) {
+						join(i * ncols, i * ncols + j_w[0]);
+					}
+				}
+			}
+			dunes = count_sets();
+			
+			// crests: brinks of slip faces
+			crest_cells = 0;
+			for (int i = 0; i < nrows; i++) {
+				for (int j = 0; j < ncols; j++) {
+					downwind(i, j, wd, i_d, j_d);
+					crest[i * ncols + j] = false;
+					if (surf[i][j] - surf[i_d][j_d] >= avalanche_thresh) {
+						// the upwind neighbour, found by going downwind in the opposite direction
+						downwind(i, j, (wd == 1 || wd == 3) ? wd + 1 : wd - 1, i_u, j_u);
+						if (surf[i_u][j_u] - surf[i][j] < avalanche_thresh) {
+							crest[i * ncols + j] = true;
+							crest_cells++;
+						}
+					}
+				}
+			}
+			// crest lines: union-find over 8 neighbours, and crest ends
+			crest_ends = 0;
+			for (int x = 0; x < nrows * ncols; x++) {
+				parent[x] = crest[x] ? x : -1;
+			}
+			for (int i = 0; i < nrows; i++) {
+				for (int j = 0; j < ncols; j++) {
+					if (!crest[i * ncols + j]) {
+						continue;
+					}
+					int ni[8] = {i_n[i], i_n[i], i_n[i], i, i, i_s[i], i_s[i], i_s[i]};
+					int nj[8] = {j_w[j], j, j_e[j], j_w[j], j_e[j], j_w[j], j, j_e[j]};
+					nb = 0;
+					for (int k = 0; k < 8; k++) {
+						// mirrored edges send some neighbours back onto the cell or onto another neighbour
+						bool seen = (ni[k] == i && nj[k] == j);
+						for (int q = 0; q < k; q++) {
+							if (ni[q] == ni[k] && nj[q] == nj[k]) { seen = true; }
+						}
+						if (!seen && crest[ni[k] * ncols + nj[k]]) {
+							join(i * ncols + j, ni[k] * ncols + nj[k]);
+							nb++;
+						}
+					}
+					if (nb == 1) {
+						crest_ends++;
+					}
+				}
+			}
+			crest_lines = count_sets();
+			
+			// crest spacing along the wind lines
+			if (wd == 1 || wd == 2) {
+				for (int j = 0; j < ncols; j++) {
+					int last = -1;
+					for (int i = 0; i < nrows; i++) {
+						if (crest[i * ncols + j]) {
+							if (last >= 0) { gap_sum += i - last; gaps++; }
+							last = i;
+						}
+					}
+				}
+			}
+			else {
+				for (int i = 0; i < nrows; i++) {
+					int last = -1;
+					for (int j = 0; j < ncols; j++) {
+						if (crest[i * ncols + j]) {
+							if (last >= 0) { gap_sum += j - last; gaps++; }
+							last = j;
+						}
+					}
+				}
+			}
+			
+			fprintf (pMorph, "%i,%i,%.3f,%i,%i,%.6f,%.3f\n", t, dunes,
+				(dunes > 0) ? (double)dune_cells / dunes : 0.0, crest_cells, crest_lines,
+				(crest_cells > 0) ? (double)crest_ends / crest_cells : 0.0,
+				(gaps > 0) ? (double)gap_sum / gaps : 0.0);
+			fflush (pMorph);
+		}
+		
+		// Method to run at the end of each iteration
+		void record(double mean_height) {
+			if (active && (t + 1) % interval == 0) {
+				measure(mean_height);
+			}
+		}
+		
+		// Method to finalize
+		void finalize() {
+			if (active) {
+				fclose (pMorph);
+			}
+		}
+};
+
+class fftplan {
+	/*
+	A self-contained complex FFT of any length n. Powers of two are done directly with an iterative
+	radix-2 transform. Other lengths use Bluestein's chirp-z algorithm, which turns the transform into
+	a circular convolution done with radix-2 transforms of the next power of two at least 2n - 1 long.
+	The plan (bit reversal, twiddles, chirp and the transformed chirp filter) and the work buffers are
+	set up once by init and reused by every call.
+	*/
+	
+	public:
+		int n;					// transform length
+		int m;					// radix-2 length
+		bool pow2;				// n is a power of two (m = n)
+		int * rev;				// bit reversal permutation for m
+		double * tw_re;			// twiddles for m: exp(-2 pi i k / m), k < m / 2
+		double * tw_im;
+		double * ch_re;			// chirp: exp(-i pi j^2 / n), j < n
+		double * ch_im;
+		double * f_re;			// radix-2 transform of the chirp filter
+		double * f_im;
+		double * w_re;			// work buffer (m)
+		double * w_im;
+		
+		//  CONSTRUCTOR
+		fftplan() {
+
+		}
+		
+		void init(int len) {
+			// SET UP the plan for length len
+			int bits = 0;
+			n = len;
+			m = 1;
+			while (m < n) { m = m * 2; }
+			pow2 = (m == n);
+			if (!pow2) {
+				m = 1;
+				while (m < 2 * n - 1) { m = m * 2; }
+			}
+			while ((1 << bits) < m) { bits++; }
+			
+			try {
+				rev = new int [m];
+				tw_re = new double [m / 2 + 1];
+				tw_im = new double [m / 2 + 1];
+				w_re = new double [m];
+				w_im = new double [m];
+				ch_re = new double [n];
+				ch_im = new double [n];
+				f_re = new double [m];
+				f_im = new double [m];
+			}
+			catch(...) {
+				cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+				exit (10);
+			}
+			for (int k = 0; k < m; k++) {
+				rev[k] = 0;
+				for (int b = 0; b < bits; b++) {
+					if (k & (1 << b)) { rev[k] = rev[k] | (1 << (bits - 1 - b)); }
+				}
+			}
+			for (int k = 0; k < m / 2; k++) {
+				tw_re[k] = cos (2.0 * M_PI * k / m);
+				tw_im[k] = -sin (2.0 * M_PI * k / m);
+			}
+			if (pow2) {
+				return;
+			}
+			
+			// chirp, with j^2 taken modulo 2n to keep the angle accurate for long transforms
+			for (int j = 0; j < n; j++) {
+				double ang = M_PI * (double)(((long long)j * j) % (2 * (long long)n)) / n;
+				ch_re[j] = cos (ang);
+				ch_im[j] = -sin (ang);
+			}
+			// filter: conjugate chirp at lags -(n - 1) to n - 1, wrapped around the m buffer
+			for (int k = 0; k < m; k++) {
+				f_re[k] = 0.0; f_im[k] = 0.0;
+			}
+			for (int j = 0; j < n; j++) {
+				f_re[j] = ch_re[j]; f_im[j] = -ch_im[j];
+				if (j > 0) {
+					f_re[m - j] = ch_re[j]; f_im[m - j] = -ch_im[j];
+				}
+			}
+			radix2(f_re, f_im, false);
+		}
+		
+		// Method for the in-place radix-2 transform of length m
+		void radix2(double * re, double * im, bool inverse) {
+			double t_re, t_im, u_re, u_im, c, sg;
+			sg = inverse ? -1.0 : 1.0;
+			for (int k = 0; k < m; k++) {
+				if (rev[k] > k) {
+					t_re = re[k]; re[k] = re[rev[k]]; re[rev[k]] = t_re;
+					t_im = im[k]; im[k] = im[rev[k]]; im[rev[k]] = t_im;
+				}
+			}
+			for (int len = 2; len <= m; len = len * 2) {
+				int half = len / 2;
+				int step = m / len;
+				for (int s = 0; s < m; s += len) {
+					for (int k = 0; k < half; k++) {
+						c = tw_re[k * step];
+						u_im = sg * tw_im[k * step];
+						t_re = re[s + k + half] * c - im[s + k + half] * u_im;
+						t_im = re[s + k + half] * u_im + im[s + k + half] * c;
+						u_re = re[s + k];
+						re[s + k + half] = u_re - t_re;
+						re[s + k] = u_re + t_re;
+						u_re = im[s + k];
+						im[s + k + half] = u_re - t_im;
+						im[s + k] = u_re + t_im;
+					}
+				}
+			}
+		}
+		
+		// Method for the in-place forward transform of length n
+		void forward(double * re, double * im) {
+			double a_re, a_im;
+			if (pow2) {
+				radix2(re, im, false);
+				return;
+			}
+			// Bluestein: chirp the input, convolve with the filter, chirp the output
+			for (int j = 0; j < m; j++) {
+				w_re[j] = 0.0; w_im[j] = 0.0;
+			}
+			for (int j = 0; j < n; j++) {
+				w_re[j] = re[j] * ch_re[j] - im[j] * ch_im[j];
+				w_im[j] = re[j] * ch_im[j] + im[j] * ch_re[j];
+			}
+			radix2(w_re, w_im, false);
+			for (int k = 0; k < m; k++) {
+				a_re = w_re[k] * f_re[k] - w_im[k] * f_im[k];
+				a_im = w_re[k] * f_im[k] + w_im[k] * f_re[k];
+				w_re[k] = a_re; w_im[k] = a_im;
+			}
+			radix2(w_re, w_im, true);
+			for (int k = 0; k < n; k++) {
+				a_re = w_re[k] / m; a_im = w_im[k] / m;
+				re[k] = a_re * ch_re[k] - a_im * ch_im[k];
+				im[k] = a_re * ch_im[k] + a_im * ch_re[k];
+			}
+		}
+};
+
+class spectrum {
+	/*
+	The spectrum object takes the 2D power spectrum of the surface every K iterations and writes
+	out the radially averaged spectrum, the spectrum along the wind axis (averaged across the wind)
+	and the dominant wavelengths of both, so wavelength through time can be followed without
+	writing out any grids.
+	
+	The surface is a real field: rows are transformed two at a time as the real and imaginary parts
+	of one complex transform and split apart using the symmetry of real transforms, and only the
+	non-negative column wavenumbers (0 to ncols / 2) are transformed down the columns. The mean
+	height is taken off first so the zero wavenumber carries no power.
+	
+	Radial bins are 1 / max(nrows, ncols) cycles per cell wide, out to the Nyquist wavenumber.
+	Wavelengths are in cells. Outputs: 'spectrum.csv' (iteration, dominant radial wavelength,
+	dominant wind axis wavelength), 'spectrum_radial.csv' and 'spectrum_wind.csv' (iteration and
+	the power in each bin). The object is switched on by 'spectrum_params.txt': interval (iterations), or by
+	spectrum_interval in the configuration file.
+	*/
+	
+	public:
+		bool active;			// is the object switched on
+		int interval;			// iterations between measurements
+		int nk;					// number of column wavenumbers kept (ncols / 2 + 1)
+		int nrad;				// number of radial bins
+		fftplan row_plan;		// plans for the row and column transforms
+		fftplan col_plan;
+		double * s_re;			// half spectrum, nrows by nk
+		double * s_im;
+		double * r_re;			// row / column buffers
+		double * r_im;
+		double * rad;			// radial spectrum and weights
+		double * rad_w;
+		double * wind;			// wind axis spectrum and weights
+		double * wind_w;
+		FILE * pSpec;			// output files
+		FILE * pRad;
+		FILE * pWind;
+		
+		//  CONSTRUCTOR
+		spectrum() {
+			active = false;
+		}
+		
+		void init() {
+			// INITIALIZE the spectrum object, if it is switched on (settings checked in validate_params), and plan
+			int nmax = (nrows > ncols) ? nrows : ncols;
+			if (!spectrum_on) {
+				return;
+			}
+			interval = spectrum_interval;
+			
+			nk = ncols / 2 + 1;
+			nrad = nmax / 2 + 1;
+			row_plan.init(ncols);
+			col_plan.init(nrows);
+			try {
+				s_re = new double [nrows * nk];
+				s_im = new double [nrows * nk];
+				r_re = new double [nmax];
+				r_im = new double [nmax];
+				rad = new double [nrad];
+				rad_w = new double [nrad];
+				wind = new double [nmax];
+				wind_w = new double [nmax];
+			}
+			catch(...) {
+				cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+				exit (10);
+			}
+			
+			pSpec = fopen ("spectrum.csv", "w");
+			fprintf (pSpec, "%s", "iteration,radial_wavelength,wind_wavelength\n");
+			pRad = fopen ("spectrum_radial.csv", "w");
+			pWind = fopen ("spectrum_wind.csv", "w");
+			active = true;
+		}
+		
+		// Method to measure the spectrum
+		void measure(double mean_height) {
+			int wd = (wdir == 5) ? obl_cardinal : wdir;
+			bool wind_on_rows = (wd == 3 || wd == 4);		// wind blows along the rows (j axis)
+			int nmax = (nrows > ncols) ? nrows : ncols;
+			int nwind = wind_on_rows ? nk : (nrows / 2 + 1);
+			int i, k, kn, ky, bin;
+			double p, w, fx, fy;
+			
+			// rows, two at a time
+			for (i = 0; i < nrows; i += 2) {
+				for (int j = 0; j < ncols; j++) {
+					r_re[j] = surf[i][j] - mean_height;
+					r_im[j] = (i + 1 < nrows) ? surf[i + 1][j] - mean_height : 0.0;
+				}
+				row_plan.forward(r_re, r_im);
+				for (k = 0; k < nk; k++) {
+					kn = (ncols - k) % ncols;
+					// X_a = (Z[k] + conj Z[-k]) / 2, X_b = (Z[k] - conj Z[-k]) / 2i
+					s_re[i * nk + k] = 0.5 * (r_re[k] + r_re[kn]);
+					s_im[i * nk + k] = 0.5 * (r_im[k] - r_im[kn]);
+					if (i + 1 < nrows) {
+						s_re[(i + 1) * nk + k] = 0.5 * (r_im[k] + r_im[kn]);
+						s_im[(i + 1) * nk + k] = -0.5 * (r_re[k] - r_re[kn]);
+					}
+				}
+			}
+			
+			// columns, and the averages
+			for (bin = 0; bin < nrad; bin++) {
+				rad[bin] = 0.0; rad_w[bin] = 0.0;
+			}
+			for (bin = 0; bin < nmax; bin++) {
+				wind[bin] = 0.0; wind_w[bin] = 0.0;
+			}
+			for (k = 0; k < nk; k++) {
+				for (i = 0; i < nrows; i++) {
+					r_re[i] = s_re[i * nk + k];
+					r_im[i] = s_im[i * nk + k];
+				}
+				col_plan.forward(r_re, r_im);
+				// wavenumbers between 0 and Nyquist stand for their negative twins too
+				w = (k == 0 || 2 * k == ncols) ? 1.0 : 2.0;
+				fx = (double)k / ncols;
+				for (i = 0; i < nrows; i++) {
+					p = r_re[i] * r_re[i] + r_im[i] * r_im[i];
+					ky = (i <= nrows / 2) ? i : nrows - i;
+					fy = (double)ky / nrows;
+					bin = (int)floor (sqrt (fx * fx + fy * fy) * nmax + 0.5);
+					if (bin < nrad) {
+						rad[bin] += w * p; rad_w[bin] += w;
+					}
+					bin = wind_on_rows ? k : ky;
+					wind[bin] += w * p; wind_w[bin] += w;
+				}
+			}
+			
+			// averages, and the dominant wavelengths (skipping the zero wavenumber)
+			int best_rad = 1, best_wind = 1;
+			fprintf (pRad, "%i", t);
+			for (bin = 0; bin < nrad; bin++) {
+				rad[bin] = (rad_w[bin] > 0.0) ? rad[bin] / rad_w[bin] : 0.0;
+				fprintf (pRad, ",%.6g", rad[bin]);
+				if (bin > 0 && rad[bin] > rad[best_rad]) { best_rad = bin; }
+			}
+			fprintf (pRad, "%s", "\n");
+			fprintf (pWind, "%i", t);
+			for (bin = 0; bin < nwind; bin++) {
+				wind[bin] = (wind_w[bin] > 0.0) ? wind[bin] / wind_w[bin] : 0.0;
+				fprintf (pWind, ",%.6g", wind[bin]);
+				if (bin > 0 && wind[bin] > wind[best_wind]) { best_wind = bin; }
+			}
+			fprintf (pWind, "%s", "\n");
+			fprintf (pSpec, "%i,%.3f,%.3f\n", t, (double)nmax / best_rad,
+				(double)(wind_on_rows ? ncols : nrows) / best_wind);
+			fflush (pSpec); fflush (pRad); fflush (pWind);
+		}
+		
+		// Method to run at the end of each iteration
+		void record(double mean_height) {
+			if (active && (t + 1) % interval == 0) {
+				measure(mean_height);
+			}
+		}
+		
+		// Method to finalize
+		void finalize() {
+			if (active) {
+				fclose (pSpec); fclose (pRad); fclose (pWind);
+			}
 		}
 };
 
-// Initialization of slablogger object in GLOBAL SCOPE!
+// Initialization of analysis objects in GLOBAL SCOPE!
 slablogger wdune_slablogger;
+fieldstats wdune_fieldstats;
+steadymonitor wdune_steady;
+morphology wdune_morphology;
+spectrum wdune_spectrum;
 
 // Initialize the analysis functions
 void init_analysis()
 {
 	wdune_slablogger.init();	// initialize at runtime (allocate memory)
+	wdune_fieldstats.init();	// initialize the running totals
+	wdune_steady.init();		// switch on the steady state monitor, if asked for
+	wdune_morphology.init();	// switch on the morphology measurements, if asked for
+	wdune_spectrum.init();		// switch on the spectral analysis, if asked for
 }
 
 // Run analysis functions
 void analyze_wdune()
 {
+	// the steady state monitor samples the flux before the slablogger resets it
+	if (wdune_steady.sample(wdune_slablogger.trans_log[0] + wdune_slablogger.avi_log[0],
+		wdune_fieldstats.roughness(), wdune_fieldstats.cover())) {
+		stop_run = true;		// steady state: the main loop finishes after this iteration
+	}
 	wdune_slablogger.record();
+	wdune_fieldstats.record();
+	wdune_morphology.record(wdune_fieldstats.mean());
+	wdune_spectrum.record(wdune_fieldstats.mean());
 }
 
 // Finalize the analysis functions
 void final_analysis()
 {
 	wdune_slablogger.finalize();
+	wdune_fieldstats.finalize();
+	wdune_steady.finalize();
+	wdune_morphology.finalize();
+	wdune_spectrum.finalize();
 }
 
 
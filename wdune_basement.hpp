@@ -0,0 +1,256 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Basement store: the non-erodible basement, read once and compressed
+/*
+The basement never changes after it is read and in most runs it is constant or flat over wide
+areas, so it is not kept as a full grid. If it is one value everywhere the store is just that
+value. Otherwise the grid is split into blocks of 64 by 64 cells, and every block keeps its
+minimum and maximum; only blocks that are not flat keep their cells. The sand test (surface
+above basement) then mostly resolves from the block: above the maximum there is sand, at or
+below the minimum there is none, and only in between is the cell itself read.
+
+The store is built once in init_basement and read only from then on, so it can be shared by
+everything that reads the model. With backing files (see wdune_grids.hpp) the stored blocks go to
+'bsmt.bin' in the backing directory and are mapped back read only.
+*/
+
+const int bsmt_shift = 6;                   // log2 of the block size
+const int bsmt_block = 1 << bsmt_shift;     // rows and columns per basement block
+
+// basement variables
+bool bsmt_const = false;            // is the basement one value everywhere
+int bsmt_value;                     // that value
+int bsmt_bcols;                     // blocks per row of blocks
+int bsmt_nblocks;                   // number of blocks
+int bsmt_nraw = 0;                  // number of blocks that keep their cells
+int * bsmt_min;                     // minimum of each block
+int * bsmt_max;                     // maximum of each block
+int ** bsmt_raw;                    // cells of each block (bsmt_block rows of bsmt_block), NULL if flat
+
+inline int bsmt_at(int i, int j)    // basement height of a cell
+{
+    if (bsmt_const)
+    {
+        return bsmt_value;
+    }
+    int b = (i >> bsmt_shift) * bsmt_bcols + (j >> bsmt_shift);
+    if (bsmt_raw[b] == NULL)
+    {
+        return bsmt_min[b];
+    }
+    return bsmt_raw[b][((i & (bsmt_block - 1)) << bsmt_shift) + (j & (bsmt_block - 1))];
+}
+
+inline bool above_bsmt(int i, int j, int h)     // is a surface of height h at a cell above the basement (is there sand)
+{
+    if (bsmt_const)
+    {
+        return h > bsmt_value;
+    }
+    int b = (i >> bsmt_shift) * bsmt_bcols + (j >> bsmt_shift);
+    if (h > bsmt_max[b])
+    {
+        return true;
+    }
+    if (h <= bsmt_min[b])
+    {
+        return false;
+    }
+    return h > bsmt_raw[b][((i & (bsmt_block - 1)) << bsmt_shift) + (j & (bsmt_block - 1))];
+}
+
+void init_basement()                // read the basement and build the store
+{
+    int i0, i1, j0, j1, b, v, scan;
+    int * band;                     // one row of blocks as read from the file
+    int * cells;                    // cells of the block being stored
+    long * offset = NULL;           // position of each stored block in the backing file
+    FILE *pBsmt, *pBin = NULL;
+    char path[1100];
+
+    pBsmt = fopen ("bsmt.txt", "r");
+    if (pBsmt == NULL)
+    {
+        cout << "ERROR WITH BASEMENT FILE" << endl;
+        exit (11);
+    }
+    bsmt_bcols = (ncols + bsmt_block - 1) / bsmt_block;
+    bsmt_nblocks = ((nrows + bsmt_block - 1) / bsmt_block) * bsmt_bcols;
+    try {
+        band = new int [bsmt_block * ncols];
+        cells = new int [bsmt_block * bsmt_block];
+        bsmt_min = new int [bsmt_nblocks];
+        bsmt_max = new int [bsmt_nblocks];
+        bsmt_raw = new int * [bsmt_nblocks];
+        if (grid_mapped)
+        {
+            offset = new long [bsmt_nblocks];
+        }
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    if (grid_mapped)
+    {
+        grid_path (path, "bsmt.bin");
+        pBin = fopen (path, "wb");
+        if (pBin == NULL)
+        {
+            cout << "ERROR WITH BACKING FILE: " << path << endl;
+            exit (11);
+        }
+    }
+
+    // read a row of blocks at a time and store each block
+    for (i0 = 0; i0 < nrows; i0 = i0 + bsmt_block)
+    {
+        i1 = (i0 + bsmt_block < nrows) ? i0 + bsmt_block : nrows;
+        for (int i = i0; i < i1; i++)
+        {
+            for (int j = 0; j < ncols; j++)
+            {
+                scan = fscanf (pBsmt, "%d", &band[(i - i0) * ncols + j]);
+                if (scan != 1)
+                {
+                    cout << "ERROR WITH BASEMENT FILE" << endl;
+                    exit (11);
+                }
+            }
+        }
+        for (j0 = 0; j0 < ncols; j0 = j0 + bsmt_block)
+        {
+            j1 = (j0 + bsmt_block < ncols) ? j0 + bsmt_block : ncols;
+            b = (i0 >> bsmt_shift) * bsmt_bcols + (j0 >> bsmt_shift);
+            bsmt_min[b] = bsmt_max[b] = band[j0];
+            for (int i = i0; i < i1; i++)
+            {
+                for (int j = j0; j < j1; j++)
+                {
+                    v = band[(i - i0) * ncols + j];
+                    cells[((i - i0) << bsmt_shift) + (j - j0)] = v;
+                    if (v < bsmt_min[b]) { bsmt_min[b] = v; }
+                    if (v > bsmt_max[b]) { bsmt_max[b] = v; }
+                }
+            }
+            bsmt_raw[b] = NULL;
+            if (bsmt_min[b] == bsmt_max[b])
+            {
+                continue;           // flat block, the minimum is all there is to it
+            }
+            if (grid_mapped)
+            {
+                offset[b] = (long)bsmt_nraw * bsmt_block * bsmt_block;
+                fwrite (cells, sizeof (int), bsmt_block * bsmt_block, pBin);
+                bsmt_raw[b] = cells;        // marks the block as stored until the file is mapped
+            }
+            else
+            {
+                try {
+                    bsmt_raw[b] = new int [bsmt_block * bsmt_block];
+                }
+                catch(...) {
+                    cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+                    exit (10);
+                }
+                for (int x = 0; x < bsmt_block * bsmt_block; x++)
+                {
+                    bsmt_raw[b][x] = cells[x];
+                }
+            }
+            bsmt_nraw++;
+        }
+    }
+    fclose (pBsmt);
+    delete [] band;
+
+    // one value everywhere: keep just the value
+    bsmt_const = (bsmt_nraw == 0);
+    bsmt_value = bsmt_min[0];
+    for (b = 1; b < bsmt_nblocks && bsmt_const; b++)
+    {
+        bsmt_const = (bsmt_min[b] == bsmt_value);
+    }
+
+    // map the stored blocks back read only
+    if (grid_mapped)
+    {
+        fclose (pBin);
+        if (bsmt_nraw > 0)
+        {
+            int fd = open (path, O_RDONLY);
+            void * p = mmap (NULL, (size_t)bsmt_nraw * bsmt_block * bsmt_block * sizeof (int),
+                PROT_READ, MAP_SHARED, fd, 0);
+            close (fd);
+            if (fd < 0 || p == MAP_FAILED)
+            {
+                cout << "CANNOT MAP BACKING FILE: " << path << endl;
+                exit (10);
+            }
+            for (b = 0; b < bsmt_nblocks; b++)
+            {
+                if (bsmt_raw[b] != NULL)
+                {
+                    bsmt_raw[b] = (int *)p + offset[b];
+                }
+            }
+        }
+        delete [] offset;
+    }
+    delete [] cells;
+
+    if (bsmt_const)
+    {
+        delete [] bsmt_min;
+        delete [] bsmt_max;
+        delete [] bsmt_raw;
+        cout << "Basement: constant at " << bsmt_value << endl;
+    }
+    else
+    {
+        cout << "Basement: " << bsmt_nraw << " of " << bsmt_nblocks << " blocks stored" << endl;
+    }
+}
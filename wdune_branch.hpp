@@ -0,0 +1,283 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Branches: continuation runs forked from a shared spin-up
+/*
+With 'branches = N' and 'branch_at = T' in the configuration file the run is a spin-up of T
+iterations followed by N continuation runs that differ in their wind or new sand. At iteration T
+the process forks one child for every branch. The children share the pages of the spun-up
+model (surface, shadow, basement, lookups, tile sets) with the parent copy-on-write, so a branch
+starts from the exact surface, shadow and sampler state at once, and only the pages it writes to
+are copied. Each branch re-seeds its random numbers (the seed drawn at the fork plus the branch
+number), takes its settings from line b of 'branches.txt':
+    wind direction (1 = north, 2 = South, 3 = east, 4 = west, 5 = oblique at the azimuth of the
+    run, only if the run is oblique), deposition jump, shadow drop distance, new sand code,
+    new sand slabs
+and runs on to the last iteration. A branch with the wind of the spin-up keeps its shadow as it
+is; a branch with another wind (or after a wind schedule, which the branches replace with their
+fixed wind) rebuilds the shadow once, as a change of regime does.
+
+The parent waits for the branches and then writes the spun-up surface to 'surf.txt'; branch b
+writes 'surf_bb.txt' (surf_b1.txt, surf_b2.txt, ...) and checks its mass balance from the start
+of the run. A branch whose mass balance is off exits with 12, and the spin-up, after writing
+'surf.txt', exits with 12 if any branch crashed or exited with an error. The analysis add-ins
+cover the spin-up and are closed at the fork, so their files are not shared by the branches;
+branch 1 prints the progress. The grids must be in memory (mapped backing files would be shared
+by every branch) and the domain cannot also be split over ranks.
+
+The shadow sweeps write every cell of the lines they pass, so over a long branch most of the
+pages of the grids are copied in the end. What the branches never pay for is the spin-up and the
+start of the model: reading the input files, building the basement store and the first shadow.
+Each branch prints how much memory it copied and how much it still shares at its end.
+*/
+
+struct branch_conf                  // the settings of a branch, a line of branches.txt
+{
+    int wdir;                       // wind direction
+    int depjump;                    // deposition jump
+    double dropdist;                // shadow drop distance
+    int newSandCode;                // new sand code
+    int newSandSlabs;               // new sand slabs
+};
+
+// branch variables
+branch_conf * branch_list;          // the branches, 1 to nbranches at 0 to nbranches - 1
+pid_t branch_pid[max_branches + 1]; // processes of the branches (the spin-up)
+bool branch_forked = false;         // have the branches been forked (or is this one of them)
+unsigned long branch_seed;          // seed of this branch
+long long branch_mass0;             // mass at the start of the run
+int branch_failed = 0;              // branches that crashed, exited with an error or lost mass
+
+void init_branches()                // read the branches, before the spin-up
+{
+    FILE *pBranch, *pMap;
+    branch_conf c;
+    int type, side;
+
+    if (nbranches == 0)
+    {
+        return;
+    }
+    if (grid_mapped)
+    {
+        cout << "ERROR: BRANCHES NEED THE GRIDS IN MEMORY" << endl;
+        exit (12);
+    }
+    pBranch = fopen ("branches.txt", "r");
+    if (pBranch == NULL)
+    {
+        cout << "CANNOT OPEN branches.txt" << endl;
+        exit (11);
+    }
+    try {
+        branch_list = new branch_conf [nbranches];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    for (int b = 0; b < nbranches; b++)
+    {
+        if (fscanf (pBranch, "%d %d %lf %d %d", &c.wdir, &c.depjump, &c.dropdist, &c.newSandCode, &c.newSandSlabs) != 5)
+        {
+            cout << "ERROR: branches.txt HAS " << b << " LINES FOR " << nbranches << " BRANCHES" << endl;
+            exit (11);
+        }
+        type = c.newSandCode / 10;
+        side = c.newSandCode % 10;
+        if (c.wdir < 1 || c.wdir > 5 || (c.wdir == 5 && wdir != 5) || c.depjump < 1 || c.dropdist <= 0.0 || c.newSandSlabs < 0
+            || !(c.newSandCode == 0 || c.newSandCode == 30 || ((type == 1 || type == 2) && side >= 1 && side <= 4)))
+        {
+            cout << "ERROR: branches.txt LINE " << b + 1 << " MUST BE A WIND OF 1 TO 4 (5 IF THE RUN IS OBLIQUE),"
+                << " A POSITIVE depjump AND dropdist, A NEW SAND CODE AND SLABS AS IN THE ARGUMENTS" << endl;
+            exit (11);
+        }
+        pMap = (c.newSandCode == 30 && newSandCode != 30) ? fopen ("supply_map.txt", "r") : NULL;
+        if (c.newSandCode == 30 && newSandCode != 30 && pMap == NULL)
+        {
+            cout << "CANNOT OPEN supply_map.txt" << endl;
+            exit (11);
+        }
+        if (pMap != NULL)
+        {
+            fclose (pMap);
+        }
+        branch_list[b] = c;
+    }
+    fclose (pBranch);
+    branch_mass0 = dom_mass();
+    cout << nbranches << " branches from iteration " << branch_at << endl;
+}
+
+void branch_apply(const branch_conf &c)    // switch this process to the settings of its branch
+{
+    bool rewind = (wind_nregimes > 0 || c.wdir != wdir || c.depjump != depjump || c.dropdist != dropdist);
+
+    if (c.newSandCode == 30 && newSandCode != 30)
+    {
+        newSandCode = 30;
+        init_supply();              // the source map was not read for the spin-up
+    }
+    if (c.newSandCode != 30)
+    {
+        supply_n = 0;               // no more sand from the source map
+    }
+    newSandCode = c.newSandCode;
+    newSandSlabs = c.newSandSlabs;
+    if (rewind)
+    {
+        wind_nregimes = 0;          // a fixed wind from here on
+        wdir = c.wdir;
+        depjump = c.depjump;
+        dropdist = c.dropdist;
+        set_bounds();
+        set_kernels();
+        init_shadupdate();          // one full shadow rebuild for the new wind
+    }
+}
+
+bool branch_update()                // fork the branches at the end of the spin-up, true in the spin-up process after they are done
+{
+    unsigned long seed;
+    int status;
+
+    if (nbranches == 0 || branch_forked || t != branch_at)     // allow quick exit from function
+    {
+        return false;
+    }
+    final_analysis();               // the analysis files hold the spin-up
+    branch_forked = true;
+    seed = rng_int32();
+    cout << "Spin-up complete at iteration " << t << " . . forking " << nbranches << " branches" << endl;
+    cout.flush();
+    fflush (NULL);                  // nothing buffered is written twice
+    for (int b = 1; b <= nbranches; b++)
+    {
+        branch_pid[b] = fork ();
+        if (branch_pid[b] < 0)
+        {
+            cout << "ERROR: CANNOT START BRANCH " << b << endl;
+            exit (12);
+        }
+        if (branch_pid[b] == 0)
+        {
+            branch_id = b;
+            break;
+        }
+    }
+    if (branch_id > 0)              // a branch: its own random numbers and settings, then on with the run
+    {
+        branch_seed = seed + branch_id;
+        rng_seed (branch_seed);
+        branch_apply (branch_list[branch_id - 1]);
+        return false;
+    }
+
+    // the spin-up: wait for the branches and stop
+    for (int b = 1; b <= nbranches; b++)
+    {
+        waitpid (branch_pid[b], &status, 0);
+        if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+            cout << "ERROR: BRANCH " << b << " FAILED" << endl;
+            branch_failed++;
+        }
+    }
+    cout << "Branches complete, the spun-up surface goes to surf.txt" << endl;
+    stop_run = true;
+    return true;
+}
+
+void final_branches()               // check the mass balance of a branch and report its memory
+{
+    FILE *pRoll;
+    char line[256];
+    unsigned long kb, copied = 0, shared = 0;
+    bool got = false;
+    long long mass;
+    const branch_conf &c = branch_list[branch_id - 1];
+
+    if (branch_id == 0)
+    {
+        if (nbranches > 0 && !branch_forked)
+        {
+            cout << "Run stopped at iteration " << t << " before the branches" << endl;
+        }
+        if (branch_failed > 0)      // surf.txt is written, but the run did not succeed
+        {
+            cout << "ERROR: " << branch_failed << " OF " << nbranches << " BRANCHES FAILED" << endl;
+            exit (12);
+        }
+        return;
+    }
+    pRoll = fopen ("/proc/self/smaps_rollup", "r");
+    while (pRoll != NULL && fgets (line, sizeof (line), pRoll) != NULL)
+    {
+        if (sscanf (line, "Private_Dirty: %lu kB", &kb) == 1) { copied = kb; got = true; }
+        if (sscanf (line, "Shared_Dirty: %lu kB", &kb) == 1) { shared = kb; }
+    }
+    if (pRoll != NULL)
+    {
+        fclose (pRoll);
+    }
+    mass = dom_mass();
+    if (branch_mass0 + slabs_in - slabs_out != mass)
+    {
+        branch_failed = 1;
+    }
+    cout << "Branch " << branch_id << " (seed " << branch_seed << ", wind " << c.wdir << ", depjump " << c.depjump
+        << ", dropdist " << c.dropdist << ", new sand " << c.newSandCode << " x " << c.newSandSlabs << "): "
+        << branch_mass0 << " + " << slabs_in << " in - " << slabs_out << " out = " << mass
+        << ((branch_mass0 + slabs_in - slabs_out == mass) ? " (exact)" : " ERROR: MASS BALANCE IS OFF") << endl;
+    if (got)
+    {
+        cout << "Branch " << branch_id << " memory: " << copied / 1024.0 << " MB copied, "
+            << shared / 1024.0 << " MB shared with the spin-up" << endl;
+    }
+    if (branch_failed > 0)          // the spin-up sees the exit code
+    {
+        exit (12);
+    }
+}
@@ -0,0 +1,375 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Spin-up cache: checkpoints on disk, reused by later runs that start the same way
+/*
+Runs of a parameter sweep often share their first iterations: the same input grids, the same
+parameters and the same seed give the same surface slab for slab, however long the run is. With
+'cache_dir = path' (and a fixed 'seed') in the configuration file the core keeps checkpoints of
+its runs in that directory. Each checkpoint is filed under a key hashed from everything the run
+depends on:
+    the bytes of the input files (surf.txt, bsmt.txt, wind_schedule.txt, and supply_map.txt and
+    supply_series.txt with the source map new sand)
+    the wind, azimuth, deposition jump, psand, pnosand, drop distance, rows, columns, boundaries,
+    new sand code and slabs, erosion sampler, shadow and seed
+and the iteration it was taken at ('key_t.ckpt'). At initialization the core looks for the
+checkpoint with its key at the latest iteration up to the end of the run, restores it and only
+runs the iterations left. A run as long as one in the cache only reads it back.
+
+A checkpoint holds the surface, the generator (the whole block, so the stream carries on where
+it was), the iteration, the slabs in and out, the fraction of a slab carried by the source map
+and the place in the wind schedule. Everything else is worked out from the surface as at any
+start: the shadow is exact at the end of every iteration, so sweeping it afresh gives the same
+shadow, and the erodible cell sets of the samplers follow from the shadow.
+
+Checkpoints are taken every 'cache_every' iterations and at the end of the run (only at the end
+by default). Each is written under a temporary name and renamed, so runs can share a directory.
+Once the files in the directory add up to more than 'cache_mb' MB the least recently used go first
+(a restore counts as a use). The analysis files of a restored run start at the iteration it was
+restored at; the steady state monitor cannot be used with the cache, as its window would start
+there too. Only one rank and no branches.
+*/
+
+const int cache_version = 1;        // bumped when the checkpoint layout or the model changes
+
+struct cache_head                   // the head of a checkpoint file
+{
+    char magic[4];                  // "WDCK"
+    int version;                    // cache_version
+    unsigned long long key;         // key of the run
+    int t;                          // iteration the checkpoint was taken at
+    int nrows, ncols;               // size of the surface that follows
+    int slabs_in, slabs_out;        // mass balance
+    double supply_carry;            // fraction of a slab from the source map
+    int wind_now, wind_next;        // place in the wind schedule
+    int rng_i;                      // place in the generator block
+};
+
+// cache variables
+bool cache_on = false;              // is the cache in use
+char cache_path[1024];              // directory of the checkpoints
+unsigned long long cache_key;       // key of this run
+int cache_t0 = 0;                   // iteration the run started from (restored or 0)
+
+void cache_hash(unsigned long long &h, const void * p, size_t n)   // add bytes to a hash (FNV-1a)
+{
+    const unsigned char * b = (const unsigned char *)p;
+    for (size_t k = 0; k < n; k++)
+    {
+        h = (h ^ b[k]) * 1099511628211ULL;
+    }
+}
+
+void cache_hash_file(unsigned long long &h, const char * name)     // add the name and bytes of an input file, if it is there
+{
+    FILE *pIn;
+    char buf[65536];
+    size_t n;
+
+    cache_hash (h, name, strlen (name) + 1);
+    pIn = fopen (name, "rb");
+    if (pIn == NULL)
+    {
+        return;
+    }
+    while ((n = fread (buf, 1, sizeof (buf), pIn)) > 0)
+    {
+        cache_hash (h, buf, n);
+    }
+    fclose (pIn);
+}
+
+void cache_name(char * path, int tc)    // path of the checkpoint of this run at iteration tc (path holds 1100 chars)
+{
+    snprintf (path, 1100, "%s/%016llx_%d.ckpt", cache_path, cache_key, tc);
+}
+
+void cache_prune(const char * keep)     // delete the least recently used checkpoints over the size limit
+{
+    DIR *pDir;
+    struct dirent * e;
+    struct stat st;
+    char path[1300], oldest[1300];
+    double total, age, oldest_age;
+    int removed = 0;
+    size_t len;
+
+    while (true)
+    {
+        total = 0.0;
+        oldest_age = -1.0;
+        pDir = opendir (cache_path);
+        while (pDir != NULL && (e = readdir (pDir)) != NULL)
+        {
+            len = strlen (e->d_name);
+            snprintf (path, sizeof (path), "%s/%s", cache_path, e->d_name);
+            if (len < 5 || strcmp (e->d_name + len - 5, ".ckpt") != 0 || stat (path, &st) != 0)
+            {
+                continue;
+            }
+            total = total + st.st_size;
+            age = st.st_mtim.tv_sec + 1e-9 * st.st_mtim.tv_nsec;
+            if (strcmp (path, keep) != 0 && (oldest_age < 0.0 || age < oldest_age))
+            {
+                oldest_age = age;
+                snprintf (oldest, sizeof (oldest), "%s", path);
+            }
+        }
+        if (pDir != NULL)
+        {
+            closedir (pDir);
+        }
+        if (total <= cache_mb * 1024.0 * 1024.0 || oldest_age < 0.0)
+        {
+            break;
+        }
+        unlink (oldest);
+        removed++;
+    }
+    if (removed > 0)
+    {
+        cout << "Cache: removed " << removed << " least recently used checkpoints" << endl;
+    }
+}
+
+void cache_store()                  // write a checkpoint of the present state
+{
+    FILE *pOut;
+    cache_head h;
+    int * row;
+    char path[1100], tmp[1100];
+    bool ok;
+
+    memset (&h, 0, sizeof (h));
+    memcpy (h.magic, "WDCK", 4);
+    h.version = cache_version;
+    h.key = cache_key;
+    h.t = t;
+    h.nrows = nrows;
+    h.ncols = ncols;
+    h.slabs_in = slabs_in;
+    h.slabs_out = slabs_out;
+    h.supply_carry = supply_carry;
+    h.wind_now = wind_now;
+    h.wind_next = wind_next;
+    h.rng_i = rng_i;
+
+    cache_name (path, t);
+    snprintf (tmp, sizeof (tmp), "%s/tmp_%d_%016llx_%d", cache_path, (int)getpid (), cache_key, t);
+    pOut = fopen (tmp, "wb");
+    if (pOut == NULL)
+    {
+        cout << "Cache: cannot write " << tmp << ", no checkpoint at iteration " << t << endl;
+        return;
+    }
+    try {
+        row = new int [ncols];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    ok = fwrite (&h, sizeof (h), 1, pOut) == 1
+        && fwrite (rng_state, sizeof (rng_state), 1, pOut) == 1
+        && fwrite (rng_out, sizeof (rng_out), 1, pOut) == 1;
+    for (int i = 0; ok && i < nrows; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            row[j] = surf[i][j];
+        }
+        ok = fwrite (row, sizeof (int), ncols, pOut) == (size_t)ncols;
+    }
+    delete [] row;
+    ok = (fclose (pOut) == 0) && ok;
+    if (!ok || rename (tmp, path) != 0)
+    {
+        unlink (tmp);
+        cout << "Cache: cannot write " << path << ", no checkpoint at iteration " << t << endl;
+        return;
+    }
+    cout << "Cache: stored iteration " << t << endl;
+    cache_prune (path);
+}
+
+bool cache_restore(const char * path)  // put the state of a checkpoint in place, false if it does not fit this run
+{
+    FILE *pIn;
+    cache_head h;
+    struct stat st;
+    int * row;
+    bool ok;
+
+    pIn = fopen (path, "rb");
+    if (pIn == NULL)
+    {
+        return false;
+    }
+    ok = fstat (fileno (pIn), &st) == 0 && fread (&h, sizeof (h), 1, pIn) == 1
+        && memcmp (h.magic, "WDCK", 4) == 0 && h.version == cache_version && h.key == cache_key
+        && h.nrows == nrows && h.ncols == ncols && h.rng_i >= 0 && h.rng_i <= N
+        && (wind_nregimes == 0 || (h.wind_now >= 0 && h.wind_now < wind_nregimes))
+        && (size_t)st.st_size == sizeof (h) + sizeof (rng_state) + sizeof (rng_out) + (size_t)nrows * ncols * sizeof (int);
+    if (!ok)
+    {
+        fclose (pIn);
+        return false;
+    }
+    try {
+        row = new int [ncols];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    ok = fread (rng_state, sizeof (rng_state), 1, pIn) == 1 && fread (rng_out, sizeof (rng_out), 1, pIn) == 1;
+    for (int i = 0; ok && i < nrows; i++)
+    {
+        ok = fread (row, sizeof (int), ncols, pIn) == (size_t)ncols;
+        for (int j = 0; ok && j < ncols; j++)
+        {
+            surf[i][j] = row[j];
+        }
+    }
+    delete [] row;
+    fclose (pIn);
+    if (!ok)                        // the surface is partly overwritten by now
+    {
+        cout << "ERROR: CANNOT READ " << path << endl;
+        exit (11);
+    }
+    rng_i = h.rng_i;
+    t = h.t;
+    slabs_in = h.slabs_in;
+    slabs_out = h.slabs_out;
+    supply_carry = h.supply_carry;
+    if (wind_nregimes > 0)
+    {
+        wind_now = h.wind_now;
+        wind_next = h.wind_next;
+        set_wind (wind_now);
+    }
+    utime (path, NULL);             // a use, for the least recently used order
+    return true;
+}
+
+void init_cache()                   // key the run and restore the latest checkpoint of it (before the first shadow)
+{
+    DIR *pDir;
+    struct dirent * e;
+    char text[512], prefix[32], path[1100];
+    int tc, best = 0;
+
+    if (!config_has ("cache_dir"))
+    {
+        return;
+    }
+    snprintf (cache_path, sizeof (cache_path), "%s", config_str ("cache_dir"));
+    mkdir (cache_path, 0755);       // if it is not there yet
+    pDir = opendir (cache_path);
+    if (pDir == NULL)
+    {
+        cout << "CANNOT OPEN THE CACHE DIRECTORY " << cache_path << endl;
+        exit (11);
+    }
+    cache_on = true;
+
+    // the key: the parameters and the input files
+    cache_key = 14695981039346656037ULL;
+    snprintf (text, sizeof (text), "wdune %d %d %.17g %d %.17g %.17g %.17g %d %d %d %d %d %d %d %d",
+        cache_version, wdir, wind_azimuth, depjump, psand, pnosand, dropdist, nrows, ncols, bound_type,
+        newSandCode, newSandSlabs, engine, shadow_mode, run_seed);
+    cache_hash (cache_key, text, strlen (text));
+    cache_hash_file (cache_key, "surf.txt");
+    cache_hash_file (cache_key, "bsmt.txt");
+    cache_hash_file (cache_key, "wind_schedule.txt");
+    if (newSandCode == 30)
+    {
+        cache_hash_file (cache_key, "supply_map.txt");
+        cache_hash_file (cache_key, "supply_series.txt");
+    }
+
+    // the latest checkpoint of this run up to its end
+    snprintf (prefix, sizeof (prefix), "%016llx_", cache_key);
+    while ((e = readdir (pDir)) != NULL)
+    {
+        if (strncmp (e->d_name, prefix, 17) == 0 && sscanf (e->d_name + 17, "%d", &tc) == 1
+            && tc > best && tc <= numIterations)
+        {
+            best = tc;
+        }
+    }
+    closedir (pDir);
+    cache_name (path, best);
+    if (best > 0 && cache_restore (path))
+    {
+        cache_t0 = t;
+        cout << "Cache: restored iteration " << t << " of " << numIterations << " from " << path << endl;
+    }
+    else if (best > 0)
+    {
+        cout << "Cache: " << path << " does not fit this run, starting from iteration 0" << endl;
+    }
+    else
+    {
+        cout << "Cache: no checkpoint of this run (key " << prefix << "), starting from iteration 0" << endl;
+    }
+}
+
+void cache_update()                 // take a checkpoint at a milestone (called at the start of an iteration)
+{
+    if (cache_on && cache_every > 0 && t > cache_t0 && t % cache_every == 0)
+    {
+        cache_store();
+    }
+}
+
+void final_cache()                  // take a checkpoint at the end of the run
+{
+    if (cache_on && t > cache_t0)
+    {
+        cache_store();
+    }
+}
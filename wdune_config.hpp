@@ -0,0 +1,547 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Configuration file: named parameters in place of the argument list
+/*
+Instead of the argument list, the core can be given a single configuration file:
+    wdune_core.exe run.cfg              run with the parameters in run.cfg
+    wdune_core.exe run.cfg --dry-run    print the resolved parameters and a memory estimate, then exit
+
+The file holds one 'key = value' per line; '#' starts a comment and blank lines are skipped. Every
+key is optional: anything left out keeps its default (set_default_params). The codes can be given
+by name or by their number:
+    iterations          number of iterations
+    wind                north, south, east, west or oblique (1 to 5)
+    azimuth             degrees clockwise from north the wind is coming from (oblique only)
+    depjump             deposition jump (cells)
+    psand               probability of depositing on sand
+    pnosand             probability of depositing on no sand
+    dropdist            drop distance of the shadow downwind
+    rows                number of rows
+    cols                number of columns
+    boundaries          nonperiodic, periodic, nonperiodic_ew or nonperiodic_ns (1 to 4)
+    new_sand            none, point, edge or map, or the new sand code of the argument list
+    new_sand_side       north, south, east or west (point and edge new sand)
+    new_sand_slabs      number of slabs to add
+    engine              polling, tile or kmc (0 to 2)
+    backing_dir         directory for memory mapped grids (see wdune_grids.hpp)
+    shadow              sweep or lazy (0 or 1, see wdune_envelope.hpp, sweep by default)
+    poll_ahead          polls the polling engine prefetches ahead (see wdune_prefetch.hpp, 0 by default)
+    huge_pages          off, thp or explicit (0 to 2, see wdune_grids.hpp, off by default)
+    numa_local          1 pins the ranks to their own CPUs and memory (see wdune_exchange.hpp, 0 by default)
+    steady_window       switches on the steady state monitor, window (iterations)
+    steady_tol_flux     relative tolerances of the monitor, negative leaves the metric out
+    steady_tol_roughness    (all 0.05 by default)
+    steady_tol_cover
+    steady_checks       consecutive steady checks to stop the run (3 by default)
+    morph_interval      switches on the morphology analysis, iterations between measurements
+    morph_threshold     dune threshold, slabs above the mean height (1 by default)
+    spectrum_interval   switches on the spectrum analysis, iterations between measurements
+    ranks               processes to split the domain over (see wdune_domain.hpp, 1 by default)
+    sub_steps           exchanges between the ranks per iteration (1 by default)
+    branches            continuation runs forked after the spin-up, settings in branches.txt
+                        (see wdune_branch.hpp, 0 by default)
+    branch_at           iteration at which the spin-up ends and the branches start
+    seed                fixed seed of the random numbers (0 seeds from the clock, by default)
+    cache_dir           directory of the spin-up cache (see wdune_cache.hpp, needs a fixed seed)
+    cache_every         iterations between checkpoints (0 by default, the end of the run only)
+    cache_mb            size limit of the cache, the least recently used checkpoints go first
+                        (1024 by default)
+
+A knob given here takes the place of its old parameter file (engine.txt, backing_dir.txt,
+steady_params.txt, morph_params.txt, spectrum_params.txt). The parameter files are read with the
+configuration, so their values are checked with the keys. Grids and tables (the surface, basement,
+supply map and series, wind schedule and slab gates) stay in their own files. Unknown or repeated
+keys and values that do not parse stop the run before anything is read or allocated.
+*/
+
+const int max_config = 64;          // maximum number of lines with a key
+const int config_len = 1024;        // maximum length of a value
+const int n_config_keys = 35;
+const char * config_keys[n_config_keys] = {
+    "iterations", "wind", "azimuth", "depjump", "psand", "pnosand", "dropdist", "rows", "cols",
+    "boundaries", "new_sand", "new_sand_side", "new_sand_slabs", "engine", "backing_dir", "shadow",
+    "poll_ahead", "huge_pages", "numa_local", "steady_window", "steady_tol_flux",
+    "steady_tol_roughness", "steady_tol_cover", "steady_checks", "morph_interval", "morph_threshold", "spectrum_interval", "ranks", "sub_steps",
+    "branches", "branch_at", "seed", "cache_dir", "cache_every", "cache_mb"};
+
+// names of the codes, in code order
+const char * wind_names[5] = {"north", "south", "east", "west", "oblique"};            // 1 to 5
+const char * bound_names[4] = {"nonperiodic", "periodic", "nonperiodic_ew", "nonperiodic_ns"};  // 1 to 4
+const char * sand_names[4] = {"none", "point", "edge", "map"};                         // 0 to 3
+const char * engine_names[3] = {"polling", "tile", "kmc"};                             // 0 to 2
+const char * shadow_names[2] = {"sweep", "lazy"};                                      // 0 to 1
+const char * huge_names[3] = {"off", "thp", "explicit"};                               // 0 to 2
+
+// configuration variables
+int nconfig = 0;                            // number of keys read
+char config_key[max_config][64];            // keys read
+char config_val[max_config][config_len];    // their values
+
+char * config_trim(char * s)        // strip leading and trailing white space in place
+{
+    char * e;
+    while (*s == ' ' || *s == '\t')
+    {
+        s++;
+    }
+    e = s + strlen (s);
+    while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\n' || e[-1] == '\r'))
+    {
+        e--;
+    }
+    *e = '\0';
+    return s;
+}
+
+int config_find(const char * key)   // index of a key read from the file, -1 if it is not there
+{
+    for (int k = 0; k < nconfig; k++)
+    {
+        if (strcmp (config_key[k], key) == 0)
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+bool config_has(const char * key)   // was a key given
+{
+    return config_find (key) >= 0;
+}
+
+const char * config_str(const char * key)       // value of a key (empty if it was not given)
+{
+    int k = config_find (key);
+    return (k >= 0) ? config_val[k] : "";
+}
+
+void config_bad(const char * key)   // a value that does not parse
+{
+    cout << "ERROR IN CONFIG FILE: BAD VALUE FOR " << key << ": " << config_str (key) << endl;
+    exit (11);
+}
+
+bool config_int(const char * key, int &v)       // read an integer value, if the key was given
+{
+    char * end;
+    if (!config_has (key))
+    {
+        return false;
+    }
+    long x = strtol (config_str (key), &end, 10);
+    if (end == config_str (key) || *end != '\0')
+    {
+        config_bad (key);
+    }
+    v = (int)x;
+    return true;
+}
+
+bool config_double(const char * key, double &v)     // read a real value, if the key was given
+{
+    char * end;
+    if (!config_has (key))
+    {
+        return false;
+    }
+    v = strtod (config_str (key), &end);
+    if (end == config_str (key) || *end != '\0')
+    {
+        config_bad (key);
+    }
+    return true;
+}
+
+bool config_code(const char * key, const char ** names, int n, int first, int &v)   // read a code by name or number, if the key was given
+{
+    if (!config_has (key))
+    {
+        return false;
+    }
+    for (int k = 0; k < n; k++)
+    {
+        if (strcmp (config_str (key), names[k]) == 0)
+        {
+            v = first + k;
+            return true;
+        }
+    }
+    return config_int (key, v);
+}
+
+void read_config(const char * path)     // read the configuration file
+{
+    FILE *pConfig;
+    char line[config_len + 128];
+    char *key, *val, *eq;
+    int lineno = 0;
+    bool known;
+
+    pConfig = fopen (path, "r");
+    if (pConfig == NULL)
+    {
+        cout << "ERROR WITH CONFIG FILE: " << path << endl;
+        exit (11);
+    }
+    while (fgets (line, sizeof (line), pConfig) != NULL)
+    {
+        lineno++;
+        if (strchr (line, '#') != NULL)
+        {
+            *strchr (line, '#') = '\0';     // drop the comment
+        }
+        key = config_trim (line);
+        if (*key == '\0')
+        {
+            continue;
+        }
+        eq = strchr (key, '=');
+        if (eq == NULL)
+        {
+            cout << "ERROR IN CONFIG FILE LINE " << lineno << ": EXPECTED key = value" << endl;
+            exit (11);
+        }
+        *eq = '\0';
+        key = config_trim (key);
+        val = config_trim (eq + 1);
+        known = false;
+        for (int k = 0; k < n_config_keys; k++)
+        {
+            known = known || (strcmp (key, config_keys[k]) == 0);
+        }
+        if (!known)
+        {
+            cout << "ERROR IN CONFIG FILE LINE " << lineno << ": UNKNOWN KEY " << key << endl;
+            exit (11);
+        }
+        if (config_has (key))
+        {
+            cout << "ERROR IN CONFIG FILE LINE " << lineno << ": REPEATED KEY " << key << endl;
+            exit (11);
+        }
+        if (*val == '\0' || strlen (val) >= (size_t)config_len || nconfig >= max_config)
+        {
+            cout << "ERROR IN CONFIG FILE LINE " << lineno << ": BAD VALUE FOR " << key << endl;
+            exit (11);
+        }
+        strncpy (config_key[nconfig], key, 63);
+        config_key[nconfig][63] = '\0';
+        strcpy (config_val[nconfig], val);
+        nconfig++;
+    }
+    fclose (pConfig);
+}
+
+void read_engine_file()             // read the erosion sampler code from engine.txt, if there is one
+{
+    FILE *pEngine = fopen ("engine.txt", "r");
+    if (pEngine == NULL)
+    {
+        return;
+    }
+    if (fscanf (pEngine, "%d", &engine) != 1)
+    {
+        cout << "ERROR READING engine.txt" << endl;
+        exit (11);
+    }
+    fclose (pEngine);
+}
+
+void read_analysis_files()          // read the analysis settings from their parameter files, for those not given as keys
+{
+    FILE *pParams;
+    if (!steady_on && (pParams = fopen ("steady_params.txt", "r")) != NULL)
+    {
+        if (fscanf (pParams, "%d %lf %lf %lf %d", &steady_window, &steady_tol[0], &steady_tol[1],
+            &steady_tol[2], &steady_checks) != 5)
+        {
+            cout << "ERROR READING steady_params.txt" << endl;
+            exit (11);
+        }
+        fclose (pParams);
+        steady_on = true;
+    }
+    if (!morph_on && (pParams = fopen ("morph_params.txt", "r")) != NULL)
+    {
+        if (fscanf (pParams, "%d %d", &morph_interval, &morph_threshold) != 2)
+        {
+            cout << "ERROR READING morph_params.txt" << endl;
+            exit (11);
+        }
+        fclose (pParams);
+        morph_on = true;
+    }
+    if (!spectrum_on && (pParams = fopen ("spectrum_params.txt", "r")) != NULL)
+    {
+        if (fscanf (pParams, "%d", &spectrum_interval) != 1)
+        {
+            cout << "ERROR READING spectrum_params.txt" << endl;
+            exit (11);
+        }
+        fclose (pParams);
+        spectrum_on = true;
+    }
+}
+
+void apply_config()                 // set the model parameters from the defaults and the configuration
+{
+    int sandType = 0, sandSide = 0;
+
+    set_default_params();
+    config_int ("iterations", numIterations);
+    config_code ("wind", wind_names, 5, 1, wdir);
+    config_double ("azimuth", wind_azimuth);
+    config_int ("depjump", depjump);
+    config_double ("psand", psand);
+    config_double ("pnosand", pnosand);
+    config_double ("dropdist", dropdist);
+    config_int ("rows", nrows);
+    config_int ("cols", ncols);
+    config_code ("boundaries", bound_names, 4, 1, bound_type);
+    config_int ("new_sand_slabs", newSandSlabs);
+    if (!config_code ("engine", engine_names, 3, 0, engine))
+    {
+        read_engine_file();         // the old parameter file, checked with the key
+    }
+    config_code ("shadow", shadow_names, 2, 0, shadow_mode);
+    config_int ("poll_ahead", poll_ahead);
+    config_code ("huge_pages", huge_names, 3, 0, huge_pages);
+    config_int ("numa_local", numa_local);
+    config_int ("ranks", nranks);
+    config_int ("sub_steps", sub_steps);
+    config_int ("branches", nbranches);
+    config_int ("branch_at", branch_at);
+    config_int ("seed", run_seed);
+    config_int ("cache_every", cache_every);
+    config_int ("cache_mb", cache_mb);
+    if (config_int ("steady_window", steady_window))
+    {
+        steady_on = true;
+        config_double ("steady_tol_flux", steady_tol[0]);
+        config_double ("steady_tol_roughness", steady_tol[1]);
+        config_double ("steady_tol_cover", steady_tol[2]);
+        config_int ("steady_checks", steady_checks);
+    }
+    if (config_int ("morph_interval", morph_interval))
+    {
+        morph_on = true;
+        config_int ("morph_threshold", morph_threshold);
+    }
+    spectrum_on = config_int ("spectrum_interval", spectrum_interval);
+    read_analysis_files();          // the old parameter files, checked with the keys
+
+    // new sand: a name and a side, or the code as in the argument list
+    if (config_code ("new_sand", sand_names, 4, 0, sandType))
+    {
+        config_code ("new_sand_side", wind_names, 4, 1, sandSide);
+        if (sandType >= 10 || sandType == 0)
+        {
+            newSandCode = sandType;         // given as the full code
+        }
+        else
+        {
+            newSandCode = sandType * 10 + ((sandType == 3) ? 0 : sandSide);
+        }
+    }
+}
+
+void validate_params()              // check the model parameters, stop before the run if any are wrong
+{
+    bool ok = true;
+    int type = newSandCode / 10, side = newSandCode % 10;
+
+    if (numIterations < 1) { cout << "ERROR: iterations MUST BE POSITIVE" << endl; ok = false; }
+    if (wdir < 1 || wdir > 5) { cout << "ERROR: wind MUST BE 1 TO 5" << endl; ok = false; }
+    if (wdir == 5 && (wind_azimuth < 0.0 || wind_azimuth >= 360.0))
+    {
+        cout << "ERROR: azimuth MUST BE FROM 0 UP TO 360 WITH AN OBLIQUE WIND" << endl;
+        ok = false;
+    }
+    if (depjump < 1) { cout << "ERROR: depjump MUST BE POSITIVE" << endl; ok = false; }
+    if (psand < 0.0 || psand > 1.0) { cout << "ERROR: psand MUST BE FROM 0 TO 1" << endl; ok = false; }
+    if (pnosand < 0.0 || pnosand > 1.0) { cout << "ERROR: pnosand MUST BE FROM 0 TO 1" << endl; ok = false; }
+    if (dropdist <= 0.0) { cout << "ERROR: dropdist MUST BE POSITIVE" << endl; ok = false; }
+    if (nrows < 2 || ncols < 2) { cout << "ERROR: rows AND cols MUST BE AT LEAST 2" << endl; ok = false; }
+    if (bound_type < 1 || bound_type > 4) { cout << "ERROR: boundaries MUST BE 1 TO 4" << endl; ok = false; }
+    if (!(newSandCode == 0 || newSandCode == 30 || ((type == 1 || type == 2) && side >= 1 && side <= 4)))
+    {
+        cout << "ERROR: new sand code MUST BE 0, 11 TO 14, 21 TO 24 OR 30" << endl;
+        ok = false;
+    }
+    if (newSandSlabs < 0) { cout << "ERROR: new_sand_slabs MUST NOT BE NEGATIVE" << endl; ok = false; }
+    if (engine < 0 || engine > 2) { cout << "ERROR: engine MUST BE 0 TO 2" << endl; ok = false; }
+    if (shadow_mode < 0 || shadow_mode > 1) { cout << "ERROR: shadow MUST BE 0 OR 1" << endl; ok = false; }
+    if (shadow_mode == 1 && (wdir == 5 || nranks > 1))
+    {
+        cout << "ERROR: THE LAZY SHADOW NEEDS A CARDINAL WIND AND ONE RANK" << endl;
+        ok = false;
+    }
+    if (poll_ahead < 0 || poll_ahead > 256) { cout << "ERROR: poll_ahead MUST BE 0 TO 256" << endl; ok = false; }
+    if (huge_pages < 0 || huge_pages > 2) { cout << "ERROR: huge_pages MUST BE 0 TO 2" << endl; ok = false; }
+    if (numa_local < 0 || numa_local > 1) { cout << "ERROR: numa_local MUST BE 0 OR 1" << endl; ok = false; }
+    if (nranks < 1 || nranks > max_ranks) { cout << "ERROR: ranks MUST BE 1 TO " << max_ranks << endl; ok = false; }
+    if (sub_steps < 1) { cout << "ERROR: sub_steps MUST BE POSITIVE" << endl; ok = false; }
+    if (nbranches < 0 || nbranches > max_branches)
+    {
+        cout << "ERROR: branches MUST BE 0 TO " << max_branches << endl;
+        ok = false;
+    }
+    if (nbranches > 0 && (branch_at < 1 || branch_at >= numIterations || nranks > 1))
+    {
+        cout << "ERROR: BRANCHES NEED branch_at FROM 1 TO iterations - 1 AND ONE RANK" << endl;
+        ok = false;
+    }
+    if (steady_on && (steady_window < 2 || steady_checks < 1))
+    {
+        cout << "ERROR: steady_window MUST BE AT LEAST 2 AND steady_checks POSITIVE" << endl;
+        ok = false;
+    }
+    if (morph_on && (morph_interval < 1 || morph_threshold < 0))
+    {
+        cout << "ERROR: morph_interval MUST BE POSITIVE AND morph_threshold NOT NEGATIVE" << endl;
+        ok = false;
+    }
+    if (spectrum_on && spectrum_interval < 1) { cout << "ERROR: spectrum_interval MUST BE POSITIVE" << endl; ok = false; }
+    if ((steady_on || morph_on || spectrum_on) && nranks > 1)
+    {
+        cout << "ERROR: THE STEADY STATE, MORPHOLOGY AND SPECTRUM ANALYSES NEED ONE RANK" << endl;
+        ok = false;
+    }
+    if (run_seed < 0) { cout << "ERROR: seed MUST NOT BE NEGATIVE" << endl; ok = false; }
+    if (cache_every < 0) { cout << "ERROR: cache_every MUST NOT BE NEGATIVE" << endl; ok = false; }
+    if (cache_mb < 1) { cout << "ERROR: cache_mb MUST BE POSITIVE" << endl; ok = false; }
+    if (config_has ("cache_dir") && (run_seed == 0 || nranks > 1 || nbranches > 0))
+    {
+        cout << "ERROR: THE CACHE NEEDS A FIXED seed, ONE RANK AND NO BRANCHES" << endl;
+        ok = false;
+    }
+    if (config_has ("cache_dir") && steady_on)
+    {
+        cout << "ERROR: THE CACHE CANNOT BE USED WITH THE STEADY STATE MONITOR" << endl;
+        ok = false;
+    }
+    if (!ok)
+    {
+        exit (12);
+    }
+}
+
+void print_config()                 // print the resolved parameters, in the configuration file format
+{
+    int type = newSandCode / 10;
+    cout << "iterations = " << numIterations << endl;
+    cout << "wind = " << wind_names[wdir - 1] << endl;
+    if (wdir == 5)
+    {
+        cout << "azimuth = " << wind_azimuth << endl;
+    }
+    cout << "depjump = " << depjump << endl;
+    cout << "psand = " << psand << endl;
+    cout << "pnosand = " << pnosand << endl;
+    cout << "dropdist = " << dropdist << endl;
+    cout << "rows = " << nrows << endl;
+    cout << "cols = " << ncols << endl;
+    cout << "boundaries = " << bound_names[bound_type - 1] << endl;
+    cout << "new_sand = " << sand_names[type] << endl;
+    if (type == 1 || type == 2)
+    {
+        cout << "new_sand_side = " << wind_names[newSandCode % 10 - 1] << endl;
+    }
+    cout << "new_sand_slabs = " << newSandSlabs << endl;
+    cout << "engine = " << engine_names[engine] << endl;
+    if (shadow_mode == 1)
+    {
+        cout << "shadow = " << shadow_names[shadow_mode] << endl;
+    }
+    if (poll_ahead > 0)
+    {
+        cout << "poll_ahead = " << poll_ahead << endl;
+    }
+    if (huge_pages > 0)
+    {
+        cout << "huge_pages = " << huge_names[huge_pages] << endl;
+    }
+    if (nranks > 1)
+    {
+        cout << "ranks = " << nranks << endl;
+        cout << "sub_steps = " << sub_steps << endl;
+        cout << "numa_local = " << numa_local << endl;
+    }
+    if (nbranches > 0)
+    {
+        cout << "branches = " << nbranches << endl;
+        cout << "branch_at = " << branch_at << endl;
+    }
+    if (run_seed > 0)
+    {
+        cout << "seed = " << run_seed << endl;
+    }
+    if (steady_on)
+    {
+        cout << "steady_window = " << steady_window << endl;
+        cout << "steady_tol_flux = " << steady_tol[0] << endl;
+        cout << "steady_tol_roughness = " << steady_tol[1] << endl;
+        cout << "steady_tol_cover = " << steady_tol[2] << endl;
+        cout << "steady_checks = " << steady_checks << endl;
+    }
+    if (morph_on)
+    {
+        cout << "morph_interval = " << morph_interval << endl;
+        cout << "morph_threshold = " << morph_threshold << endl;
+    }
+    if (spectrum_on)
+    {
+        cout << "spectrum_interval = " << spectrum_interval << endl;
+    }
+    for (int k = 0; k < nconfig; k++)           // the feature knobs as given
+    {
+        if (strcmp (config_key[k], "backing_dir") == 0 || strncmp (config_key[k], "cache_", 6) == 0)
+        {
+            cout << config_key[k] << " = " << config_val[k] << endl;
+        }
+    }
+}
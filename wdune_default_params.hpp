@@ -44,8 +44,7 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 */
 
 void set_default_params() {
-	// a basic list of default parameters to test the program without argument list
-	cout << "OPERATING WITH DEFAULTS" << endl;
+	// a basic list of default parameters, the starting point for a configuration file
 	numIterations = 500;
 	wdir = 4;
 	depjump = 1;
@@ -0,0 +1,192 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Domain decomposition: strips of the grid owned by separate processes
+/*
+With more than one rank (see wdune_exchange.hpp for the processes), the grid is cut across the
+wind into strips: for north and south winds each rank owns a band of rows, for east and west
+winds a band of columns, so the wind carries sand from one strip into the next. A rank only
+erodes, deposits and avalanches on cells of its own strip. It keeps a copy of the rest of the
+surface, refreshed at every exchange, which is read for slopes at the strip edges and for the
+shadows cast into the strip from upwind.
+
+Sand only crosses a strip edge as a message to the rank that owns the cell:
+    flight      a saltating slab that lands in the strip (picksite_depo carries on from there)
+    land        a slab that comes to rest on a cell of the strip (avalanche down, new sand)
+    pull        a hole next to the strip edge: the cell slides a slab into it if it is still
+                steep enough, which comes back as a land message
+A slab is only ever on one rank or in one message, so the mass balance stays exact.
+*/
+
+// message types
+const int dom_flight = 1;
+const int dom_land = 2;
+const int dom_pull = 3;
+
+struct dom_msg                      // a slab crossing a strip edge
+{
+    int type;                       // message type
+    int i, j;                       // cell on the receiving strip
+    int hi, hj;                     // hole the slab is asked for (pull)
+    int h;                          // height of the hole when it was asked for (pull)
+};
+
+// domain variables
+int dom_rank = 0;                   // rank of this process
+bool dom_rows;                      // strips are bands of rows (else of columns)
+int dom_i0 = 0, dom_ni;             // rows of the strip (all rows with strips of columns)
+int dom_j0 = 0, dom_nj;             // columns of the strip (all columns with strips of rows)
+int * dom_owner;                    // rank owning each row (or column)
+dom_msg * dom_out;                  // messages waiting to go out
+int dom_nout = 0;                   // number of messages waiting
+int dom_capout = 0;                 // room in the outgoing list
+
+void set_strip()                    // set the strip owned by this rank
+{
+    int n;
+    dom_rows = (wdir == 1 || wdir == 2);
+    n = dom_rows ? nrows : ncols;
+    try {
+        dom_owner = new int [n];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    // nearly equal strips, in order along the axis
+    for (int r = 0; r < nranks; r++)
+    {
+        for (int a = (int)((long long)n * r / nranks); a < (int)((long long)n * (r + 1) / nranks); a++)
+        {
+            dom_owner[a] = r;
+        }
+    }
+    dom_i0 = 0; dom_ni = nrows;
+    dom_j0 = 0; dom_nj = ncols;
+    if (dom_rows)
+    {
+        dom_i0 = (int)((long long)n * dom_rank / nranks);
+        dom_ni = (int)((long long)n * (dom_rank + 1) / nranks) - dom_i0;
+    }
+    else
+    {
+        dom_j0 = (int)((long long)n * dom_rank / nranks);
+        dom_nj = (int)((long long)n * (dom_rank + 1) / nranks) - dom_j0;
+    }
+}
+
+inline bool dom_owns(int i, int j)  // is a cell on the strip of this rank
+{
+    if (nranks == 1)
+    {
+        return true;
+    }
+    return dom_owner[dom_rows ? i : j] == dom_rank;
+}
+
+void dom_send(int type, int i, int j, int hi, int hj, int h)    // queue a message for the rank owning cell i, j
+{
+    if (dom_nout == dom_capout)     // make room
+    {
+        dom_msg * grown;
+        dom_capout = (dom_capout == 0) ? 1024 : dom_capout * 2;
+        try {
+            grown = new dom_msg [dom_capout];
+        }
+        catch(...) {
+            cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+            exit (10);
+        }
+        for (int k = 0; k < dom_nout; k++)
+        {
+            grown[k] = dom_out[k];
+        }
+        if (dom_nout > 0)
+        {
+            delete [] dom_out;
+        }
+        dom_out = grown;
+    }
+    dom_out[dom_nout].type = type;
+    dom_out[dom_nout].i = i; dom_out[dom_nout].j = j;
+    dom_out[dom_nout].hi = hi; dom_out[dom_nout].hj = hj;
+    dom_out[dom_nout].h = h;
+    dom_nout++;
+}
+
+void dom_neighbour(int i, int j, int dir, int &ni, int &nj)     // neighbour in an avalanche direction (0 = north, 1 = south, 2 = east, 3 = west)
+{
+    ni = i; nj = j;
+    if (dir == 0) { ni = i_n[i]; }
+    if (dir == 1) { ni = i_s[i]; }
+    if (dir == 2) { nj = j_e[j]; }
+    if (dir == 3) { nj = j_w[j]; }
+}
+
+bool dom_pull_across(int i, int j, int dir)     // the slab to fill hole i, j is on another strip: ask for it
+{
+    int ni, nj;
+    dom_neighbour (i, j, dir, ni, nj);
+    if (dom_owns (ni, nj))
+    {
+        return false;
+    }
+    dom_send (dom_pull, ni, nj, i, j, surf[i][j]);
+    return true;
+}
+
+bool dom_land_across(int i, int j, int dir)     // the slab on i, j falls onto another strip: send it there
+{
+    int ni, nj;
+    dom_neighbour (i, j, dir, ni, nj);
+    if (dom_owns (ni, nj))
+    {
+        return false;
+    }
+    surf[i][j]--;                   // subtract the slab of sand
+    tile_refresh (i, j);
+    dom_send (dom_land, ni, nj, 0, 0, 0);
+    return true;
+}
@@ -0,0 +1,215 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Lazy shadow: the shadow of a cell worked out from its wind line when it is asked for
+/*
+Along a wind line, with positions p counted downwind from the upwind edge, the sweep in
+shadupdate gives every cell the higher of its surface and surf[k] - dropdist * (p - k) over the
+cells k upwind of it (with periodic edges, every other cell of the line, at its distance around
+the wrap). That is the highest v[k] = surf[k] + dropdist * k upwind, less dropdist * p, so the
+shadow only needs the running maximum of v along the line.
+
+With 'shadow = lazy' in the configuration file the shadow grid is not kept. Each wind line has
+a segment tree over v instead: every internal node holds the position of the highest v below
+it and the leaves are the surface itself, so the tree takes one int per cell against the double
+of the shadow grid. A shadow is a prefix query, plus a suffix query for the wrap, O(log N), and
+a slab coming onto or off a cell updates the nodes above it, O(log N), in place of a sweep of
+the whole line.
+
+The shadow is always that of the present surface. The sweeps only redo the line of the cell an
+avalanche stops on, so lines an avalanche crosses keep their old shadow until they are swept
+again; the lazy shadow has no such lag and runs are not slab for slab the same as with the
+sweeps. Cardinal winds on a single rank only.
+*/
+
+// envelope variables
+int env_n;                          // positions along a wind line
+int env_nl;                         // number of wind lines
+
+inline int env_line(int i, int j)   // wind line of a cell
+{
+    return (wdir == 1 || wdir == 2) ? j : i;
+}
+
+inline int env_pos(int i, int j)    // position of a cell along its wind line, from the upwind edge
+{
+    if (wdir == 1) { return i; }
+    if (wdir == 2) { return nrows - 1 - i; }
+    if (wdir == 3) { return ncols - 1 - j; }
+    return j;
+}
+
+inline int env_surf(int l, int p)   // surface at a position along a wind line
+{
+    if (wdir == 1) { return surf[p][l]; }
+    if (wdir == 2) { return surf[nrows - 1 - p][l]; }
+    if (wdir == 3) { return surf[l][ncols - 1 - p]; }
+    return surf[l][p];
+}
+
+inline int env_node(int l, int x)   // position of the highest v below node x of line l (leaves are x >= env_n)
+{
+    return (x >= env_n) ? x - env_n : env_data[(size_t)l * env_n + x];
+}
+
+inline int env_higher(int l, int a, int b)  // the position with the higher v (-1 is none)
+{
+    if (a < 0) { return b; }
+    if (b < 0) { return a; }
+    return (env_surf (l, b) + dropdist * b > env_surf (l, a) + dropdist * a) ? b : a;
+}
+
+int env_highest(int l, int p0, int p1)      // position of the highest v from p0 up to p1 - 1 (-1 if empty)
+{
+    int best = -1;
+    for (p0 = p0 + env_n, p1 = p1 + env_n; p0 < p1; p0 = p0 / 2, p1 = p1 / 2)
+    {
+        if (p0 & 1) { best = env_higher (l, best, env_node (l, p0++)); }
+        if (p1 & 1) { best = env_higher (l, best, env_node (l, --p1)); }
+    }
+    return best;
+}
+
+void env_build_line(int l)          // rebuild the tree of a wind line from the surface
+{
+    for (int x = env_n - 1; x > 0; x--)
+    {
+        env_data[(size_t)l * env_n + x] = env_higher (l, env_node (l, 2 * x), env_node (l, 2 * x + 1));
+    }
+}
+
+void env_build()                    // rebuild every wind line (at the start and when the wind changes)
+{
+    env_n = (wdir == 1 || wdir == 2) ? nrows : ncols;
+    env_nl = (wdir == 1 || wdir == 2) ? ncols : nrows;
+    for (int l = 0; l < env_nl; l++)
+    {
+        env_build_line(l);
+    }
+}
+
+void env_update(int i, int j)       // the surface of a cell has changed, update the nodes above it
+{
+    int l = env_line (i, j);
+    for (int x = (env_pos (i, j) + env_n) / 2; x > 0; x = x / 2)
+    {
+        env_data[(size_t)l * env_n + x] = env_higher (l, env_node (l, 2 * x), env_node (l, 2 * x + 1));
+    }
+}
+
+double env_shadow(int i, int j)     // shadow height of a cell, from the trees of its line
+{
+    int l = env_line (i, j), p = env_pos (i, j), k;
+    double h = surf[i][j], s;
+    k = env_highest (l, 0, p);                      // casters upwind
+    if (k >= 0)
+    {
+        s = env_surf (l, k) - dropdist * (p - k);
+        if (s > h) { h = s; }
+    }
+    if (shadloops > 1)                              // periodic: casters around the wrap
+    {
+        k = env_highest (l, p + 1, env_n);
+        if (k >= 0)
+        {
+            s = env_surf (l, k) - dropdist * (p - k + env_n);
+            if (s > h) { h = s; }
+        }
+    }
+    return h;
+}
+
+inline double shad_at(int i, int j)  // shadow height of a cell
+{
+    if (shadow_mode == 0)
+    {
+        return shad[i][j];
+    }
+    return env_shadow (i, j);
+}
+
+template <int SH>
+inline double shad_at_k(int i, int j)    // shadow height of a cell, with the shadow mode fixed (in the kernels)
+{
+    return (SH == 0) ? shad[i][j] : env_shadow (i, j);
+}
+
+int env_reach(int i, int j)         // cells downwind of a changed cell whose shadow may have changed
+{
+    /*
+    Stops at the first cell downwind with a v at least that of the changed cell before or after
+    the change (a slab either way): from there on that cell casts at least as high a shadow.
+    */
+    int l = env_line (i, j), p = env_pos (i, j), q, n = 0;
+    double top = env_surf (l, p) + 1 + dropdist * p, v;
+    for (int u = p + 1; u < p + env_n; u++)
+    {
+        q = u;
+        if (q >= env_n)
+        {
+            if (shadloops < 2)
+            {
+                break;              // non-periodic: the line leaves the model space
+            }
+            q = q - env_n;
+        }
+        v = env_surf (l, q) + dropdist * u;
+        if (v >= top)
+        {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+void env_cell(int l, int p, int &i, int &j)     // cell at a position along a wind line
+{
+    p = p % env_n;
+    if (wdir == 1) { i = p; j = l; }
+    if (wdir == 2) { i = nrows - 1 - p; j = l; }
+    if (wdir == 3) { i = l; j = ncols - 1 - p; }
+    if (wdir == 4) { i = l; j = p; }
+}
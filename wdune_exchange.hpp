@@ -0,0 +1,399 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Rank processes and the exchanges between them
+/*
+The ranks are processes forked from the initialized model (init_ranks), so every rank starts
+from the same surface, shadow and basement and re-seeds its random numbers. They share one
+anonymous memory map holding a barrier, a mailbox for every pair of ranks and a copy of the
+whole surface that each rank publishes its strip into.
+
+Every iteration is split into sub-steps (sub_steps in the configuration file). In a sub-step
+each rank polls its share of its strip's cells, then the ranks exchange (dom_exchange):
+    1) messages go out in rounds until no rank has any left: every round the queued messages
+       are put in the mailboxes, each rank takes in what was sent to it and handles it (which
+       can queue more messages, for instance a pull that comes back as a land)
+    2) each rank publishes its strip, then copies the other strips into its own surface and
+       sweeps the shadow along every wind line that changed
+Rank 0 adds the new sand in the last sub-step, before the exchange. The surface on rank 0 is
+whole after every exchange, so rank 0 writes 'surf.txt' at the end and checks the mass
+balance over all ranks.
+
+Only fixed cardinal winds and the polling engine can be split. The analysis add-ins keep
+their running totals but are not run (they would only count the events of one rank): they open
+no files, and the steady state, morphology and spectrum settings are refused with more than one
+rank.
+*/
+
+const int dom_mailbox = 4096;       // messages per mailbox (pair of ranks) per round
+
+struct dom_shared                   // the head of the shared memory map
+{
+    int bar_count;                  // ranks waiting at the barrier
+    int bar_gen;                    // barrier generation
+    int busy[2];                    // messages still queued after a round, by round parity
+    int slabs_in[max_ranks];        // mass balance of each rank at the end
+    int slabs_out[max_ranks];
+    int mail_n[max_ranks][max_ranks];       // messages in each mailbox (sender, receiver)
+};
+
+// exchange variables
+dom_shared * dom_sh;                // shared head
+dom_msg * dom_mail;                 // shared mailboxes, nranks by nranks by dom_mailbox
+int * dom_surf;                     // shared copy of the whole surface
+dom_msg * dom_in;                   // messages taken in this round
+int dom_round = 0;                  // round counter (for the parity of busy)
+long long dom_mass0;                // mass at the start (rank 0)
+pid_t dom_pid[max_ranks];           // processes of the other ranks (rank 0)
+
+void dom_barrier()                  // wait until every rank gets here
+{
+    int gen = __atomic_load_n (&dom_sh->bar_gen, __ATOMIC_ACQUIRE);
+    if (__atomic_add_fetch (&dom_sh->bar_count, 1, __ATOMIC_ACQ_REL) == nranks)
+    {
+        __atomic_store_n (&dom_sh->bar_count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n (&dom_sh->bar_gen, gen + 1, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        while (__atomic_load_n (&dom_sh->bar_gen, __ATOMIC_ACQUIRE) == gen)
+        {
+            sched_yield ();
+        }
+    }
+}
+
+long long dom_mass()                // slabs above the basement in the surface of this process
+{
+    long long mass = 0;
+    for (int i = 0; i < nrows; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            mass = mass + surf[i][j] - bsmt_at(i, j);
+        }
+    }
+    return mass;
+}
+
+void rank_place()                   // pin this rank to its share of the CPUs and make its strip local to them
+{
+    /*
+    The grids are filled before the fork, so all their pages start out on the memory node of the
+    first rank. Each rank pins itself to a CPU of its own, spread over the machine so the ranks
+    fall on every socket, and writes its strip back over itself: the first write to a page after
+    the fork copies it, and the kernel puts the copy on the node of the CPU that writes.
+    */
+    cpu_set_t set;
+    long ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+    int cpu = (int)((long)dom_rank * ncpu / nranks);
+    volatile int * s;
+    volatile double * h;
+
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    if (sched_setaffinity (0, sizeof (set), &set) != 0)
+    {
+        cout << "Rank " << dom_rank << " could not be pinned to CPU " << cpu << endl;
+    }
+    for (int i = dom_i0; i < dom_i0 + dom_ni; i++)
+    {
+        for (int j = dom_j0; j < dom_j0 + dom_nj; j++)
+        {
+            s = &surf[i][j];
+            *s = *s;
+            if (shadow_mode == 0)
+            {
+                h = &shad[i][j];
+                *h = *h;
+            }
+        }
+    }
+}
+
+void init_ranks()                   // fork the ranks and set up the shared memory
+{
+    size_t bytes;
+    char * p;
+    unsigned long seed;
+
+    if (nranks == 1)
+    {
+        set_strip();                // the whole grid
+        return;
+    }
+    if (wdir == 5 || wind_nregimes > 0 || engine != 0 || (wdir <= 2 ? nrows : ncols) < nranks)
+    {
+        cout << "ERROR: SPLITTING THE DOMAIN NEEDS A FIXED CARDINAL WIND, THE POLLING ENGINE"
+            << " AND A STRIP OF AT LEAST ONE LINE FOR EVERY RANK" << endl;
+        exit (12);
+    }
+
+    // shared memory: head, mailboxes and the surface copy
+    bytes = sizeof (dom_shared) + (size_t)nranks * nranks * dom_mailbox * sizeof (dom_msg)
+        + (size_t)nrows * ncols * sizeof (int);
+    p = (char *)mmap (NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    dom_sh = (dom_shared *)p;       // anonymous maps start zeroed
+    dom_mail = (dom_msg *)(p + sizeof (dom_shared));
+    dom_surf = (int *)(p + sizeof (dom_shared) + (size_t)nranks * nranks * dom_mailbox * sizeof (dom_msg));
+    try {
+        dom_in = new dom_msg [nranks * dom_mailbox];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    dom_mass0 = dom_mass();
+
+    // fork the other ranks, each draws its own random numbers from here on
+    seed = rng_int32();
+    cout.flush();
+    for (int r = 1; r < nranks; r++)
+    {
+        dom_pid[r] = fork ();
+        if (dom_pid[r] < 0)
+        {
+            cout << "ERROR: CANNOT START RANK " << r << endl;
+            exit (12);
+        }
+        if (dom_pid[r] == 0)
+        {
+            dom_rank = r;
+            break;
+        }
+    }
+    rng_seed (seed + dom_rank);
+    set_strip();
+    if (numa_local == 1)
+    {
+        rank_place();               // local pages for the strip of this rank
+    }
+    if (dom_rank == 0)
+    {
+        cout << "Domain split over " << nranks << " ranks, " << sub_steps << " exchanges per iteration" << endl;
+    }
+}
+
+void dom_receive(dom_msg &m)        // handle a message for this strip
+{
+    if (m.type == dom_flight)       // carry on the saltation from where the slab landed
+    {
+        if (rng_real1() < depo_prob(m.i, m.j))
+        {
+            deposit(m.i, m.j);
+        }
+        else
+        {
+            picksite_depo(m.i, m.j);
+            deposit(i_depo, j_depo);
+        }
+    }
+    if (m.type == dom_land)         // the slab comes to rest here
+    {
+        surf[m.i][m.j]++;
+        avalanche_down(m.i, m.j);
+    }
+    if (m.type == dom_pull)         // slide a slab into the hole if the cell is still steep enough
+    {
+        if (surf[m.i][m.j] - m.h > avalanche_thresh && above_bsmt(m.i, m.j, surf[m.i][m.j]))
+        {
+            dom_send(dom_land, m.hi, m.hj, 0, 0, 0);
+            surf[m.i][m.j]--;
+            avalanche_up(m.i, m.j);
+        }
+    }
+}
+
+void dom_exchange()                 // exchange messages and strips between the ranks
+{
+    int sent, kept, nin, dst, b;
+    dom_msg * box;
+
+    // 1) messages, in rounds until none are left anywhere
+    while (true)
+    {
+        // put the queued messages in the mailboxes, keep what does not fit for the next round
+        kept = 0;
+        for (int k = 0; k < dom_nout; k++)
+        {
+            dst = dom_owner[dom_rows ? dom_out[k].i : dom_out[k].j];
+            sent = dom_sh->mail_n[dom_rank][dst];
+            if (sent < dom_mailbox)
+            {
+                dom_mail[((size_t)dom_rank * nranks + dst) * dom_mailbox + sent] = dom_out[k];
+                dom_sh->mail_n[dom_rank][dst] = sent + 1;
+            }
+            else
+            {
+                dom_out[kept] = dom_out[k];
+                kept++;
+            }
+        }
+        dom_nout = kept;
+        dom_barrier();
+
+        // take in the messages sent here
+        nin = 0;
+        for (int src = 0; src < nranks; src++)
+        {
+            box = dom_mail + ((size_t)src * nranks + dom_rank) * dom_mailbox;
+            for (int k = 0; k < dom_sh->mail_n[src][dom_rank]; k++)
+            {
+                dom_in[nin] = box[k];
+                nin++;
+            }
+            dom_sh->mail_n[src][dom_rank] = 0;
+        }
+
+        // handle them, the shadow is swept once they are all in
+        defer_shadow = true;
+        for (int k = 0; k < nin; k++)
+        {
+            dom_receive(dom_in[k]);
+        }
+        defer_shadow = false;
+        dirty_shadupdate();
+
+        // done when no rank has anything queued
+        b = dom_round % 2;
+        __atomic_add_fetch (&dom_sh->busy[b], dom_nout, __ATOMIC_ACQ_REL);
+        if (dom_rank == 0)
+        {
+            dom_sh->busy[1 - b] = 0;    // ready for the next round
+        }
+        dom_barrier();
+        dom_round++;
+        if (__atomic_load_n (&dom_sh->busy[b], __ATOMIC_ACQUIRE) == 0)
+        {
+            break;
+        }
+    }
+
+    // 2) publish this strip, then take in the others
+    for (int i = dom_i0; i < dom_i0 + dom_ni; i++)
+    {
+        for (int j = dom_j0; j < dom_j0 + dom_nj; j++)
+        {
+            dom_surf[(size_t)i * ncols + j] = surf[i][j];   // cell by cell, the row need not be contiguous (GRID_TILE)
+        }
+    }
+    dom_barrier();
+    for (int i = 0; i < nrows; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            if (!dom_owns(i, j) && surf[i][j] != dom_surf[(size_t)i * ncols + j])
+            {
+                surf[i][j] = dom_surf[(size_t)i * ncols + j];
+                dirty_row[i] = true; dirty_col[j] = true;
+            }
+        }
+    }
+    dirty_shadupdate();             // shadows cast into the strip from upwind
+}
+
+void dom_run()                      // one iteration of this rank's strip
+{
+    int own = dom_ni * dom_nj;
+    int polls;
+
+    for (int s = 0; s < sub_steps; s++)
+    {
+        polls = own / sub_steps + ((s < own % sub_steps) ? 1 : 0);
+        for (int t_poll = 0; t_poll < polls; t_poll++)
+        {
+            poll_prefetch();                    // prefetch the cells of the polls ahead, if asked for
+            picksite_ero();                     // pick a site to erode from
+            if (ero_flag)                       // flag is true if the site is good for erosion
+            {
+                erode_at(i_ero, j_ero);             // erode the site and carry the slab downwind
+            }
+        }
+        if (s == sub_steps - 1 && dom_rank == 0)
+        {
+            newSandEngine();                    // add some new sand if required
+            supplyEngine();                     // add new sand from the source map if required
+        }
+        dom_exchange();
+    }
+}
+
+void final_ranks()                  // gather the mass balance on rank 0 and end the other ranks
+{
+    long long mass;
+    if (nranks == 1)
+    {
+        return;
+    }
+    dom_sh->slabs_in[dom_rank] = slabs_in;
+    dom_sh->slabs_out[dom_rank] = slabs_out;
+    dom_barrier();
+    if (dom_rank != 0)
+    {
+        _exit (0);                  // leave the files (open in every rank since the fork) to rank 0
+    }
+    for (int r = 1; r < nranks; r++)
+    {
+        waitpid (dom_pid[r], NULL, 0);
+        slabs_in = slabs_in + dom_sh->slabs_in[r];
+        slabs_out = slabs_out + dom_sh->slabs_out[r];
+    }
+    mass = dom_mass();
+    cout << "Mass balance over the ranks: " << dom_mass0 << " + " << slabs_in << " in - " << slabs_out
+        << " out = " << mass;
+    if (dom_mass0 + slabs_in - slabs_out == mass)
+    {
+        cout << " (exact)" << endl;
+    }
+    else
+    {
+        cout << " ERROR: MASS BALANCE IS OFF BY " << mass - (dom_mass0 + slabs_in - slabs_out) << endl;
+    }
+}
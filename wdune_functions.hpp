@@ -45,588 +45,460 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 
 // Core functions for Werner Dune
 
-void periodic_bounds()              // set periodic boundaries
+void cardinal_bounds(bool per_ns, bool per_ew)     // set up the lookups for a cardinal wind, each axis periodic or not
 {
-    // setup the lookup arrays for the periodic boundaries
+    /*
+    Setup the lookup arrays, the edges are duplicated with non-periodic
+    boundaries (similar to a mirror). Sand will not avalanche off the edge of the modelspace, but
+    it can be transported out of the modelspace by the wind. We've chosen to mirror the edges,
+	but this could be modified. See Fonstad (2006, Geomorphology 77, 217-234) for more discussion.
+    */
+    bool per = (wdir == 1 || wdir == 2) ? per_ns : per_ew;     // is the axis along the wind periodic
+
     for (int i = 0; i < nrows; i++)
     {
         i_n[i] = i - 1;
         i_s[i] = i + 1;
     }
-    i_n[0] = (nrows - 1);
-    i_s[nrows - 1] = 0;
+    i_n[0] = per_ns ? (nrows - 1) : 0;              // wrapped or mirrored edges
+    i_s[nrows - 1] = per_ns ? 0 : (nrows - 1);
 
     for (int j = 0; j < ncols; j++)
     {
         j_e[j] = j + 1;
         j_w[j] = j - 1;
     }
-    j_w[0] = (ncols - 1);
-    j_e[ncols - 1] = 0;
+    j_w[0] = per_ew ? (ncols - 1) : 0;              // wrapped or mirrored edges
+    j_e[ncols - 1] = per_ew ? 0 : (ncols - 1);
 
-    // setup deposition coordinates
-    if (wdir == 1) // northerly: periodic boundary
-    {
-        for (int i = 0; i < nrows; i++)
-        {
-            if ((i + depjump) < nrows)  // if still within range, set shift
-            {
-                i_dp[i] = i + depjump;
-            }
-            else                        // else write from the beginning again
-            {
-                i_dp[i] = i + depjump - nrows;
-            }
-        }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 2;
-    }
-
-    if (wdir == 2) // southerly: periodic boundary
+    // setup deposition coordinates: a jump along the wind, written from the beginning again
+    // past a periodic edge and set as toxic past a non-periodic one, no shift across the wind
+    for (int i = 0; i < nrows; i++)
     {
-        for (int i = 0; i < nrows; i++)
+        i_dp[i] = i;
+        if (wdir == 1) // northerly
         {
-            if ((i - depjump) >= 0)  // if still within range, set shift
-            {
-                i_dp[i] = i - depjump;
-            }
-            else                     // else write from the beginning again
-            {
-                i_dp[i] = nrows + i - depjump;
-            }
+            i_dp[i] = ((i + depjump) < nrows) ? (i + depjump) : (per ? (i + depjump - nrows) : i_toxic);
         }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
+        if (wdir == 2) // southerly
         {
-            j_dp[j] = j;
+            i_dp[i] = ((i - depjump) >= 0) ? (i - depjump) : (per ? (nrows + i - depjump) : i_toxic);
         }
-        shadloops = 2;
     }
-
-    if (wdir == 3) // easterly: periodic boundary
+    for (int j = 0; j < ncols; j++)
     {
-        for (int j = 0; j < ncols; j++)
+        j_dp[j] = j;
+        if (wdir == 3) // easterly
         {
-            if ((j - depjump) >= 0)  // if still within range, set shift
-            {
-                j_dp[j] = j - depjump;
-            }
-            else        // else write from the beginning again
-            {
-                j_dp[j] = ncols + j - depjump;
-            }
+            j_dp[j] = ((j - depjump) >= 0) ? (j - depjump) : (per ? (ncols + j - depjump) : j_toxic);
         }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
+        if (wdir == 4) // westerly
         {
-            i_dp[i] = i;
+            j_dp[j] = ((j + depjump) < ncols) ? (j + depjump) : (per ? (j + depjump - ncols) : j_toxic);
         }
-        shadloops = 2;
-
     }
+    shadloops = per ? 2 : 1;
+}
 
-    if (wdir == 4) // westerly: periodic boundary
+int oblique_cardinal()              // cardinal direction sharing the major axis of an oblique wind
+{
+    double vi = cos (wind_azimuth * M_PI / 180.0);
+    double vj = -sin (wind_azimuth * M_PI / 180.0);
+    if (fabs (vj) > fabs (vi))
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j + depjump) < ncols)  // if still within range, set shift
-            {
-                j_dp[j] = j + depjump;
-            }
-            else        // else write from the beginning again
-            {
-                j_dp[j] = j + depjump - ncols;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 2;
+        return (vj > 0) ? 4 : 3;
     }
+    return (vi > 0) ? 1 : 2;
 }
 
-void nonperiodic_bounds()           // set up non-periodic boundaries
+void oblique_bounds()               // set up the lookups for an oblique wind (wdir = 5)
 {
     /*
-    Setup the lookup arrays, the edges are duplicated with non-periodic
-    boundaries (similar to a mirror). Sand will not avalanche off the edge of the modelspace, but
-    it can be transported out of the modelspace by the wind. We've chosen to mirror the edges,
-	but this could be modified. See Fonstad (2006, Geomorphology 77, 217-234) for more discussion.
+    Oblique winds follow digital (Bresenham) lines across the grid. The axis the wind has the
+    larger component along is the major axis, every step along a wind line moves one cell along
+    it and 0 or 1 cells along the minor axis. The minor steps only depend on the major coordinate,
+    so the lines are set by two small tables: the minor step leaving each major coordinate (used
+    by the shadow) and the minor shift of a whole deposition jump (used by transport). The wrap
+    lookups take a coordinate that has stepped past an edge back into the grid (periodic) or
+    flag it as toxic (non-periodic). The cardinal lookups for the major axis are set up as well
+    and used by the slablogger gate.
     */
-    for (int i = 0; i < nrows; i++)
+    double vi = cos (wind_azimuth * M_PI / 180.0);     // component of the wind blowing toward increasing i
+    double vj = -sin (wind_azimuth * M_PI / 180.0);    // component of the wind blowing toward increasing j
+    double slope;
+    int nmajor, nminor, sgn, k;
+    bool mper, nper;
+
+    obl_majj = (fabs (vj) > fabs (vi));
+    if (obl_majj)
     {
-        i_n[i] = i - 1;
-        i_s[i] = i + 1;
+        obl_mstep = (vj > 0) ? 1 : -1;
+        obl_cardinal = (vj > 0) ? 4 : 3;
+        nmajor = ncols; nminor = nrows;
+        slope = fabs (vi / vj);
+        sgn = (vi > 0) ? 1 : -1;
+        mper = (bound_type == 2 || bound_type == 4);
+        nper = (bound_type == 2 || bound_type == 3);
     }
-    i_n[0] = 0;                         // mirrored edges
-    i_s[nrows - 1] = (nrows - 1);
-
-    for (int j = 0; j < ncols; j++)
+    else
     {
-        j_e[j] = j + 1;
-        j_w[j] = j - 1;
+        obl_mstep = (vi > 0) ? 1 : -1;
+        obl_cardinal = (vi > 0) ? 1 : 2;
+        nmajor = nrows; nminor = ncols;
+        slope = fabs (vj / vi);
+        sgn = (vj > 0) ? 1 : -1;
+        mper = (bound_type == 2 || bound_type == 3);
+        nper = (bound_type == 2 || bound_type == 4);
+    }
+    obl_drop = dropdist * sqrt (1.0 + slope * slope);  // a step along the line is longer than a cell
+    obl_pad = depjump + 1;
+
+    delete [] obl_d; delete [] obl_ddp; delete [] obl_mwrap; delete [] obl_nwrap;
+    try {
+        obl_d = new int [nmajor];
+        obl_ddp = new int [nmajor];
+        obl_mwrap = new int [nmajor + 2 * obl_pad];
+        obl_nwrap = new int [nminor + 2 * obl_pad];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
     }
-    j_w[0] = 0;                         // mirrored edges
-    j_e[ncols - 1] = (ncols - 1);
 
-    // setup deposition coordinates
-    if (wdir == 1) // northerly: non-periodic boundary
+    // minor steps, from the position along the line counted from the upwind edge
+    for (int m = 0; m < nmajor; m++)
     {
-        for (int i = 0; i < nrows; i++)
-        {
-            if ((i + depjump) < nrows)  // if still within range, set shift
-            {
-                i_dp[i] = i + depjump;
-            }
-            else                        // else set the coordinate as toxic
-            {
-                i_dp[i] = i_toxic;
-            }
-        }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 1;
+        k = (obl_mstep > 0) ? m : (nmajor - 1 - m);
+        obl_d[m] = sgn * (int)(floor ((k + 1) * slope + 0.5) - floor (k * slope + 0.5));
+        obl_ddp[m] = sgn * (int)(floor ((k + depjump) * slope + 0.5) - floor (k * slope + 0.5));
     }
 
-    if (wdir == 2) // southerly: non-periodic boundary
+    // wrap lookups, entry x + obl_pad is the coordinate x taken back onto the grid
+    for (int x = -obl_pad; x < nmajor + obl_pad; x++)
     {
-        for (int i = 0; i < nrows; i++)
-        {
-            if ((i - depjump) >= 0)  // if still within range, set shift
-            {
-                i_dp[i] = i - depjump;
-            }
-            else                        // else set the coordinate as toxic
-            {
-                i_dp[i] = i_toxic;
-            }
-        }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 1;
+        if (x >= 0 && x < nmajor) { obl_mwrap[x + obl_pad] = x; }
+        else if (mper) { obl_mwrap[x + obl_pad] = (x + nmajor) % nmajor; }
+        else { obl_mwrap[x + obl_pad] = i_toxic; }
     }
-
-    if (wdir == 3) // easterly: non-periodic boundary
+    for (int x = -obl_pad; x < nminor + obl_pad; x++)
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j - depjump) >= 0)  // if still within range, set shift
-            {
-                j_dp[j] = j - depjump;
-            }
-            else        // else set the coordinate as toxic
-            {
-                j_dp[j] = j_toxic;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 1;
+        if (x >= 0 && x < nminor) { obl_nwrap[x + obl_pad] = x; }
+        else if (nper) { obl_nwrap[x + obl_pad] = (x + nminor) % nminor; }
+        else { obl_nwrap[x + obl_pad] = i_toxic; }
     }
+}
 
-    if (wdir == 4) // westerly: non-periodic boundary
+void set_bounds()                   // set the boundary lookups for the present boundary type and wind
+{
+    int wd = wdir;
+    if (wd == 5) { wdir = oblique_cardinal(); }     // oblique winds use the lookups of their major axis too
+
+    cardinal_bounds (bound_type == 2 || bound_type == 3, bound_type == 2 || bound_type == 4);
+
+    if (wd == 5)
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j + depjump) < ncols)  // if still within range, set shift
-            {
-                j_dp[j] = j + depjump;
-            }
-            else        // else set the coordinate as toxic
-            {
-                j_dp[j] = j_toxic;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 1;
+        wdir = 5;
+        oblique_bounds();
     }
 }
 
-void nonperiodic_bounds_EW()        // set up non-periodic boundaries E-W, periodic boundaries N-S
+void oblique_shadupdate (int i, int j)      // update the shadow downwind of a site, oblique winds
 {
     /*
-    Setup the lookup arrays, the edges are duplicated with non-periodic
-    boundaries (similar to a mirror). Sand will not avalanche off the edge of the modelspace, but
-    it can be transported out of the modelspace by the wind. We've chosen to mirror the edges,
-	but this could be modified. See Fonstad (2006, Geomorphology 77, 217-234) for more discussion.
+    Walks down the wind line from the site, each cell takes the higher of its surface and the
+    shadow of the cell upwind less the drop. The walk stops when it reaches a cell whose
+    shadow does not change, as nothing further down the line can change either.
     */
-    for (int i = 0; i < nrows; i++)
-    {
-        i_n[i] = i - 1;
-        i_s[i] = i + 1;
-    }
-    i_n[0] = (nrows - 1);
-    i_s[nrows - 1] = 0;
-
-    for (int j = 0; j < ncols; j++)
+    int m = obl_majj ? j : i;       // major and minor coordinates
+    int n = obl_majj ? i : j;
+    int mp, np, mn, nn;
+    int steps = 0;
+    int nmajor = obl_majj ? ncols : nrows;
+    double s_new, s_up;
+
+    while (steps < (nmajor * shadloops))
     {
-        j_e[j] = j + 1;
-        j_w[j] = j - 1;
-    }
-    j_w[0] = 0;                     // mirrored edges
-    j_e[ncols - 1] = (ncols - 1);
+        double &s_here = obl_majj ? shad[n][m] : shad[m][n];
+        s_new = obl_majj ? surf[n][m] : surf[m][n];
 
-    // setup deposition coordinates
-    if (wdir == 1) // northerly: periodic boundary
-    {
-        for (int i = 0; i < nrows; i++)
+        // the cell upwind along the line, if there is one
+        mp = obl_mwrap[m - obl_mstep + obl_pad];
+        if (mp != i_toxic)
         {
-            if ((i + depjump) < nrows)  // if still within range, set shift
-            {
-                i_dp[i] = i + depjump;
-            }
-            else                        // else write from the beginning again
+            np = obl_nwrap[n - obl_d[mp] + obl_pad];
+            if (np != i_toxic)
             {
-                i_dp[i] = i + depjump - nrows;
+                s_up = (obl_majj ? shad[np][mp] : shad[mp][np]) - obl_drop;
+                if (s_up > s_new) { s_new = s_up; }
             }
         }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
+        if (steps > 0 && s_new == s_here)
         {
-            j_dp[j] = j;
+            break;              // no change from here on down the line
         }
-        shadloops = 2;
-    }
+        s_here = s_new;
+        if (obl_majj) { tile_refresh(n, m); } else { tile_refresh(m, n); }
 
-    if (wdir == 2) // southerly: periodic boundary
-    {
-        for (int i = 0; i < nrows; i++)
+        // move to the next cell downwind
+        mn = obl_mwrap[m + obl_mstep + obl_pad];
+        nn = obl_nwrap[n + obl_d[m] + obl_pad];
+        if (mn == i_toxic || nn == i_toxic)
         {
-            if ((i - depjump) >= 0)  // if still within range, set shift
-            {
-                i_dp[i] = i - depjump;
-            }
-            else                        // else write from the beginning again
-            {
-                i_dp[i] = nrows + i - depjump;
-            }
+            break;              // the line leaves the model space
         }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 2;
+        m = mn; n = nn;
+        steps++;
     }
+}
 
-    if (wdir == 3) // easterly: non-periodic boundary
-    {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j - depjump) >= 0)  // if still within range, set shift
-            {
-                j_dp[j] = j - depjump;
-            }
-            else        // else set the coordinate as toxic
-            {
-                j_dp[j] = j_toxic;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 1;
-    }
+void oblique_init_shadupdate()      // update the whole shadow, oblique winds
+{
+    /*
+    The shadow is swept a whole major coordinate at a time in downwind order, every cell
+    taking the shadow from its upwind cell on the previous major coordinate. As with the
+    cardinal winds, periodic edges are swept twice to let the shadows wrap around.
+    */
+    int nmajor = obl_majj ? ncols : nrows;
+    int nminor = obl_majj ? nrows : ncols;
+    int m, mp, np;
+    double s_up;
 
-    if (wdir == 4) // westerly: non-periodic boundary
+    for (int lp = 0; lp < shadloops; lp++)
     {
-        for (int j = 0; j < ncols; j++)
+        for (int k = 0; k < nmajor; k++)
         {
-            if ((j + depjump) < ncols)  // if still within range, set shift
+            m = (obl_mstep > 0) ? k : (nmajor - 1 - k);
+            mp = obl_mwrap[m - obl_mstep + obl_pad];
+            if (mp == i_toxic)
             {
-                j_dp[j] = j + depjump;
+                continue;       // upwind edge, the shadow is the surface
             }
-            else        // else set the coordinate as toxic
+            for (int n = 0; n < nminor; n++)
             {
-                j_dp[j] = j_toxic;
+                np = obl_nwrap[n - obl_d[mp] + obl_pad];
+                if (np == i_toxic)
+                {
+                    continue;   // the line enters the model space here
+                }
+                if (obl_majj)
+                {
+                    s_up = shad[np][mp] - obl_drop;
+                    if (s_up > shad[n][m]) { shad[n][m] = s_up; }
+                }
+                else
+                {
+                    s_up = shad[mp][np] - obl_drop;
+                    if (s_up > shad[m][n]) { shad[m][n] = s_up; }
+                }
             }
         }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 1;
     }
 }
 
-void nonperiodic_bounds_NS()        // set up non-periodic boundaries N-S, periodic boundaries E-W
+template <int SH>
+void cell_changed_k(int i, int j)   // a slab has come onto or off a cell, recheck it for the tile sampler
 {
-    /*
-    Setup the lookup arrays, the edges are duplicated with non-periodic
-    boundaries (similar to a mirror). Sand will not avalanche off the edge of the modelspace, but
-    it can be transported out of the modelspace by the wind. We've chosen to mirror the edges,
-	but this could be modified. See Fonstad (2006, Geomorphology 77, 217-234) for more discussion.
-    */
-    for (int i = 0; i < nrows; i++)
+    int l, p, n, i_d, j_d;
+    if (SH == 0)
     {
-        i_n[i] = i - 1;
-        i_s[i] = i + 1;
+        tile_refresh(i, j);         // the shadow waits for the next sweep of the line
+        return;
     }
-    i_n[0] = 0;             // mirrored edges
-    i_s[nrows - 1] = (nrows - 1);
-
-    for (int j = 0; j < ncols; j++)
+    env_update(i, j);               // lazy shadow: the change shows in the shadow downwind at once
+    if (!tile_mode)
     {
-        j_e[j] = j + 1;
-        j_w[j] = j - 1;
+        return;
     }
-    j_w[0] = (ncols - 1);
-    j_e[ncols - 1] = 0;
-
-    // setup deposition coordinates
-    if (wdir == 1) // northerly: non-periodic boundary
+    l = env_line(i, j); p = env_pos(i, j);
+    n = env_reach(i, j);
+    for (int u = 0; u <= n; u++)
     {
-        for (int i = 0; i < nrows; i++)
-        {
-            if ((i + depjump) < nrows)  // if still within range, set shift
-            {
-                i_dp[i] = i + depjump;
-            }
-            else                        // else set the coordinate as toxic
-            {
-                i_dp[i] = i_toxic;
-            }
-        }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 1;
+        env_cell(l, p + u, i_d, j_d);
+        tile_refresh(i_d, j_d);
     }
+}
 
-    if (wdir == 2) // southerly: non-periodic boundary
+void picksite_ero()                 // pick a site to erode from
+{
+    // first sample a random location
+    int i = dom_i0 + rng_int32() % dom_ni;     // within the strip of this rank (all of it with one rank)
+    int j = dom_j0 + rng_int32() % dom_nj;
+    /*
+	Conditions for erosion:
+        1) surface higher than basement
+        2) surface higher or equal to shadow (e.g., not in a shadow zone)
+    Notes:
+    This function is an if statement, rather than a while loop to allow
+    time to pass properly. If the conditions are assessed as part of a
+    while loop, time stands unnaturally still searching for a site for erosion.
+    */
+    if (above_bsmt(i, j, surf[i][j]) && (surf[i][j] >= shad_at(i, j)))
     {
-        for (int i = 0; i < nrows; i++)
-        {
-            if ((i - depjump) >= 0)  // if still within range, set shift
-            {
-                i_dp[i] = i - depjump;
-            }
-            else                        // else set the coordinate as toxic
-            {
-                i_dp[i] = i_toxic;
-            }
-        }
-        for (int j = 0; j < ncols; j++) // set j coordinates with no shift
-        {
-            j_dp[j] = j;
-        }
-        shadloops = 1;
+        i_ero = i; j_ero = j;   // if conditions are met, set the erosion coordinates
+        ero_flag = true;        // set the flag high
     }
-
-    if (wdir == 3) // easterly: periodic boundary
+    else
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j - depjump) >= 0)  // if still within range, set shift
-            {
-                j_dp[j] = j - depjump;
-            }
-            else        // else write from the beginning again
-            {
-                j_dp[j] = ncols + j - depjump;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 2;
-
+        ero_flag = false;       // else, no erosion this time, flag is low
     }
+}
 
-    if (wdir == 4) // westerly: periodic boundary
+template <int SH>
+double depo_prob_k(int i, int j)    // probability of a slab landing at a site depositing there
+{
+    if (surf[i][j] < shad_at_k<SH> (i, j))
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            if ((j + depjump) < ncols)  // if still within range, set shift
-            {
-                j_dp[j] = j + depjump;
-            }
-            else        // else write from the beginning again
-            {
-                j_dp[j] = j + depjump - ncols;
-            }
-        }
-        for (int i = 0; i < nrows; i++) // set i coordinates with no shift
-        {
-            i_dp[i] = i;
-        }
-        shadloops = 2;
+        return 1.0;
     }
+    // else set the probability cutoff based on psand
+    if (above_bsmt(i, j, surf[i][j]))    // if surface greater than basement, there is sand
+    {
+        return psand;
+    }
+    return pnosand;                 // else, there is no sand
 }
 
-void shadupdate (int i, int j)      // update the shadow at a given site
+double depo_prob(int i, int j)      // the same, outside the kernels
 {
-    // declare variables
-    int lpCnt;
+    return (shadow_mode == 0) ? depo_prob_k<0> (i, j) : depo_prob_k<1> (i, j);
+}
 
-    // northerly
-    if (wdir == 1)
-    {
-        // first change the shadow height to the topographic height
-        for (int i_d = 0; i_d < nrows; i_d++)
-        {
-            shad[i_d][j] = surf[i_d][j];
-        }
+// Kernels: the per-event functions, compiled for each wind direction and boundary type
+/*
+The wind direction and the boundary type are fixed for a run (or for a wind regime), so the
+functions run for every event (shadow sweep, avalanches, transport) are templates over both and
+are compiled once for each of the 20 combinations (4 cardinal winds and the oblique wind, by 4
+boundary types). set_kernels points the calls at the ones for the present wind, once at
+initialization and again when a wind schedule changes the wind. Inside a kernel the wind and
+boundary tests fold away at compile time, the neighbours and the steps along a wind line are
+worked out from the boundary type instead of read from the lookups, and the four cardinal
+directions share one sweep. The avalanche threshold is a constant already and the neighbourhood
+is always the four cardinal neighbours, so neither needs to be a parameter.
+
+The shadow mode (swept or lazy) and whether the domain is split over ranks are fixed for a run
+as well and are parameters too (an oblique wind is only ever swept on one rank). Two flags are
+left as tests at run time on purpose: defer_shadow is switched on and off within an iteration
+(while new sand is added and while the ranks exchange), and tile_mode is the engine, tested in
+tile_refresh, which the engines also call outside the kernels.
+*/
 
-        lpCnt = 0; i = 0;   // set starting coordinates for the loop to update shadow
-        while (lpCnt < (nrows * shadloops))
-        {   // check to see if the shadow can be higher and update
-            if ((shad[i_n[i]][j] - dropdist > surf[i][j]) &&
-                (shad[i_n[i]][j] - dropdist > shad[i][j]))
-                {
-                    shad[i][j] = shad[i_n[i]][j] - dropdist;
-                }
-            i = i_s[i];     // re-assign to next row down
-            lpCnt++;        // increment the loop counter
-        }
-    }
-    // southerly
-    if (wdir == 2)
-    {
-        // first change the shadow height to the topographic height
-        for (int i_d = 0; i_d < nrows; i_d++)
-        {
-            shad[i_d][j] = surf[i_d][j];
-        }
+template <int BT> struct bounds_policy      // neighbours for a boundary type (1 to 4, as bound_type)
+{
+    static const bool per_ns = (BT == 2 || BT == 3);    // rows wrap around (periodic N-S)
+    static const bool per_ew = (BT == 2 || BT == 4);    // columns wrap around (periodic E-W)
 
-        lpCnt = 0; i = (nrows - 1);   // set starting coordinates for the loop to update shadow
-        while (lpCnt < (nrows * shadloops))
-        {   // check to see if the shadow can be higher and update
-            if ((shad[i_s[i]][j] - dropdist > surf[i][j]) &&
-                (shad[i_s[i]][j] - dropdist > shad[i][j]))
-                {
-                    shad[i][j] = shad[i_s[i]][j] - dropdist;
-                }
-            i = i_n[i];     // re-assign to next row down
-            lpCnt++;        // increment the loop counter
-        }
-    }
-    // easterly
-    if (wdir == 3)
-    {
-        // first change the shadow height to the topographic height
-        for (int j_d = 0; j_d < ncols; j_d++)
-        {
-            shad[i][j_d] = surf[i][j_d];
-        }
+    static int north(int i) { return (i > 0) ? (i - 1) : (per_ns ? (nrows - 1) : 0); }
+    static int south(int i) { return (i < nrows - 1) ? (i + 1) : (per_ns ? 0 : (nrows - 1)); }
+    static int east(int j) { return (j < ncols - 1) ? (j + 1) : (per_ew ? 0 : (ncols - 1)); }
+    static int west(int j) { return (j > 0) ? (j - 1) : (per_ew ? (ncols - 1) : 0); }
+};
 
-        lpCnt = 0; j = (ncols - 1);   // set starting coordinates for the loop to update shadow
-        while (lpCnt < (ncols * shadloops))
-        {   // check to see if the shadow can be higher and update
-            if ((shad[i][j_e[j]] - dropdist > surf[i][j]) &&
-                (shad[i][j_e[j]] - dropdist > shad[i][j]))
-                {
-                    shad[i][j] = shad[i][j_e[j]] - dropdist;
-                }
-            j = j_w[j];     // re-assign the next column
-            lpCnt++;        // increment the loop counter
-        }
+template <int WD, int BT> struct line_policy    // a cardinal wind line, a column (N, S) or a row (E, W)
+{
+    static const bool cols = (WD == 1 || WD == 2);          // wind lines are columns
+    static const bool fwd = (WD == 1 || WD == 4);           // the wind blows toward increasing i or j
+    static const bool per = cols ? bounds_policy<BT>::per_ns : bounds_policy<BT>::per_ew;
+
+    static int length() { return cols ? nrows : ncols; }
+    static int up(int p)            // position upwind of p (p itself at a non-periodic edge)
+    {
+        if (cols) { return fwd ? bounds_policy<BT>::north(p) : bounds_policy<BT>::south(p); }
+        return fwd ? bounds_policy<BT>::west(p) : bounds_policy<BT>::east(p);
     }
-    // westerly
-    if (wdir == 4)
+    static int down(int p)          // position downwind of p
     {
-        // first change the shadow height to the topographic height
-        for (int j_d = 0; j_d < ncols; j_d++)
-        {
-            shad[i][j_d] = surf[i][j_d];
-        }
-
-        lpCnt = 0; j = 0;   // set starting coordinates for the loop to update shadow
-        while (lpCnt < (ncols * shadloops))
-        {   // check to see if the shadow can be higher and update
-            if ((shad[i][j_w[j]] - dropdist > surf[i][j]) &&
-                (shad[i][j_w[j]] - dropdist > shad[i][j]))
-                {
-                    shad[i][j] = shad[i][j_w[j]] - dropdist;
-                }
-            j = j_e[j];     // re-assign the next column
-            lpCnt++;        // increment the loop counter
-        }
+        if (cols) { return fwd ? bounds_policy<BT>::south(p) : bounds_policy<BT>::north(p); }
+        return fwd ? bounds_policy<BT>::east(p) : bounds_policy<BT>::west(p);
     }
-}
+    static int & surf_of(int l, int p) { return cols ? surf[p][l] : surf[l][p]; }
+    static double & shad_of(int l, int p) { return cols ? shad[p][l] : shad[l][p]; }
+};
 
-void init_shadupdate()              // set shadow update for the first time
+template <int WD, int BT, int SH, bool SPLIT>
+void shadupdate_k (int i, int j)    // update the shadow at a given site
 {
-    // first set the shadow to be identical to the present topography
-    for (int i = 0; i < nrows; i++)
-    {
-        for (int j = 0; j < ncols; j++)
-        {
-            shad[i][j] = surf [i][j];
-        }
-    }
+    /*
+    Every wind line is swept once from its upwind end. With periodic edges the line is a ring and
+    the shadow wraps around it, so the sweep starts at the tallest cell of the line instead: no
+    cell can shade it (dropdist > 0), and any shadow cast across it from upwind is lower than the
+    one it casts itself, so one pass round the ring gives the same shadow as sweeping it twice.
+    */
+    typedef line_policy<WD, BT> L;
+    int n, l, p;
+    double s_up;
 
-    // update the shadow with the shadupdate function
-    if (wdir == 1) // northerly
+    // lazy shadow: nothing to sweep, the shadow is worked out when it is asked for
+    if (SH == 1)
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            shadupdate(0, j);
-        }
+        return;
     }
 
-    if (wdir == 2) // southerly
+    // oblique
+    if (WD == 5)
     {
-        for (int j = 0; j < ncols; j++)
-        {
-            shadupdate((nrows - 1), j);
-        }
+        oblique_shadupdate(i, j);
+        return;
     }
 
-    if (wdir == 3) // easterly
+    n = L::length();
+    l = L::cols ? j : i;            // the line through the site
+    if (L::cols) { dirty_col[l] = false; } else { dirty_row[l] = false; }  // this line is swept clean
+
+    // first change the shadow height to the topographic height
+    p = L::fwd ? 0 : (n - 1);       // set starting position for the loop to update shadow
+    for (int p_d = 0; p_d < n; p_d++)
     {
-        for (int i = 0; i < nrows; i++)
-        {
-            shadupdate(i, (ncols - 1));
-        }
+        L::shad_of(l, p_d) = L::surf_of(l, p_d);
+        if (L::per && L::surf_of(l, p_d) > L::surf_of(l, p)) { p = p_d; }  // periodic: start at the tallest cell
     }
 
-    if (wdir == 4) // westerly
-    {
-        for (int i = 0; i < nrows; i++)
+    for (int lpCnt = 0; lpCnt < n; lpCnt++)
+    {   // check to see if the shadow can be higher and update
+        s_up = L::shad_of(l, L::up(p)) - dropdist;
+        if ((s_up > L::surf_of(l, p)) && (s_up > L::shad_of(l, p)))
         {
-            shadupdate(i, 0);
+            L::shad_of(l, p) = s_up;
         }
+        p = L::down(p);             // move to the next cell downwind
     }
+    if (L::cols) { tile_refresh_col(l); } else { tile_refresh_row(l); }    // recheck the swept line for the tile sampler
 }
 
-void avalanche_up(int i, int j)     // avalanche up (called after picking up a slab)
+template <int WD, int BT, int SH, bool SPLIT>
+void avalanche_up_k (int i, int j)     // avalanche up (called after picking up a slab)
 {
     // declare variables
+    typedef bounds_policy<BT> B;
 	bool avidir[4] = {false, false, false, false};  // directions which a slab could fall from
     int avi_final;        							// final decision of avalanche direction
     // coordinates of boolean are referenced as: 0 = north, 1 = south, 2 = east, 3 = west
 
+    dirty_row[i] = true; dirty_col[j] = true;       // the surface just changed here, flag the lines
+
+    // ------------------------------------------------------------------------------
+    // Analysis add-in: fieldstats (a slab was just taken off this cell)
+    wdune_fieldstats.update(surf[i][j] + 1, surf[i][j], bsmt_at(i, j));
+    // ------------------------------------------------------------------------------
+    cell_changed_k<SH> (i, j);                             // recheck whether the cell can erode
+
     // check the directions, check slope and availability of sand above the basement
     // look to the north
-    if ((surf[i_n[i]][j] - surf[i][j] > avalanche_thresh) && (surf[i_n[i]][j] - bsmt[i_n[i]][j] > 0))
+    if ((surf[B::north(i)][j] - surf[i][j] > avalanche_thresh) && above_bsmt(B::north(i), j, surf[B::north(i)][j]))
     {
         avidir[0] = true;
     }
     // look to the south
-    if ((surf[i_s[i]][j] - surf[i][j] > avalanche_thresh) && (surf[i_s[i]][j] - bsmt[i_s[i]][j] > 0))
+    if ((surf[B::south(i)][j] - surf[i][j] > avalanche_thresh) && above_bsmt(B::south(i), j, surf[B::south(i)][j]))
     {
         avidir[1] = true;
     }
     // look to the east
-    if ((surf[i][j_e[j]] - surf[i][j] > avalanche_thresh) && (surf[i][j_e[j]] - bsmt[i][j_e[j]] > 0))
+    if ((surf[i][B::east(j)] - surf[i][j] > avalanche_thresh) && above_bsmt(i, B::east(j), surf[i][B::east(j)]))
     {
         avidir[2] = true;
     }
     // look to the west
-    if ((surf[i][j_w[j]] - surf[i][j] > avalanche_thresh) && (surf[i][j_w[j]] - bsmt[i][j_w[j]] > 0))
+    if ((surf[i][B::west(j)] - surf[i][j] > avalanche_thresh) && above_bsmt(i, B::west(j), surf[i][B::west(j)]))
     {
         avidir[3] = true;
     }
@@ -637,16 +509,31 @@ void avalanche_up(int i, int j)     // avalanche up (called after picking up a s
         // break any ties and make a final decision
         do
         {
-            avi_final = genrand_int32() % 4;   // draw a random direction
+            avi_final = rng_int32() % 4;   // draw a random direction
         }
         while (!avidir[avi_final]);               // repeat until the direction is suitable for avalanche
 
+        // ------------------------------------------------------------------------------
+        // Domain add-in: the slab would come from another rank's strip, ask for it there
+        if (SPLIT && dom_pull_across(i, j, avi_final))
+        {
+            shadupdate_k<WD, BT, SH, SPLIT> (i, j);
+            return;
+        }
+        // ------------------------------------------------------------------------------
+
+        // ------------------------------------------------------------------------------
+        // Analysis add-in: fieldstats (the slab falls onto this cell)
+        wdune_fieldstats.update(surf[i][j], surf[i][j] + 1, bsmt_at(i, j));
+        // ------------------------------------------------------------------------------
+
         // move slabs	
 		// move slab from the north
 		if (avi_final == 0)
         {
 			surf[i][j]++;               // add the slab of sand that avalanches
-			i = i_n[i];                 // reset the focal coordinates
+			cell_changed_k<SH> (i, j);         // recheck the cell the slab falls onto
+			i = B::north(i);                 // reset the focal coordinates
 			
 			// ------------------------------------------------------------------------------
 			// Analysis add-in: slablogger
@@ -654,13 +541,14 @@ void avalanche_up(int i, int j)     // avalanche up (called after picking up a s
 			// ------------------------------------------------------------------------------
 
 			surf[i][j]--;               // subtract the slab of sand
-            avalanche_up (i, j);        // call the function recursively
+            avalanche_up_k<WD, BT, SH, SPLIT> (i, j);        // call the function recursively
         }
         // move slab from the south
         if (avi_final == 1)
         {
             surf[i][j]++;               // add the slab of sand that avalanches
-            i = i_s[i];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls onto
+            i = B::south(i);                 // reset the focal coordinates
             			
 			// ------------------------------------------------------------------------------
 			// Analysis add-in: slablogger
@@ -668,13 +556,14 @@ void avalanche_up(int i, int j)     // avalanche up (called after picking up a s
 			// ------------------------------------------------------------------------------
 
 			surf[i][j]--;               // subtract the slab of sand
-            avalanche_up (i, j);        // call the function recursively
+            avalanche_up_k<WD, BT, SH, SPLIT> (i, j);        // call the function recursively
         }
         // move slab from the east
         if (avi_final == 2)
         {
             surf[i][j]++;               // add the slab of sand that avalanches
-            j = j_e[j];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls onto
+            j = B::east(j);                 // reset the focal coordinates
             
 			// ------------------------------------------------------------------------------
 			// Analysis add-in: slablogger
@@ -682,13 +571,14 @@ void avalanche_up(int i, int j)     // avalanche up (called after picking up a s
 			// ------------------------------------------------------------------------------
 			
 			surf[i][j]--;               // subtract the slab of sand
-            avalanche_up (i, j);        // call the function recursively
+            avalanche_up_k<WD, BT, SH, SPLIT> (i, j);        // call the function recursively
         }
         // move slab from the west
         if (avi_final == 3)
         {
             surf[i][j]++;               // add the slab of sand that avalanches
-            j = j_w[j];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls onto
+            j = B::west(j);                 // reset the focal coordinates
 
 			// ------------------------------------------------------------------------------
 			// Analysis add-in: slablogger
@@ -696,41 +586,51 @@ void avalanche_up(int i, int j)     // avalanche up (called after picking up a s
 			// ------------------------------------------------------------------------------
 
 			surf[i][j]--;               // subtract the slab of sand
-            avalanche_up (i, j);        // call the function recursively
+            avalanche_up_k<WD, BT, SH, SPLIT> (i, j);        // call the function recursively
         }
     }
     // else, slabs are finished being moved for this call, run the shadow update
     else
     {
-        shadupdate (i, j);         // force run the shadupdate function
+        shadupdate_k<WD, BT, SH, SPLIT> (i, j);         // force run the shadupdate function
     }
 }
 
-void avalanche_down(int i, int j)   // avalanche down (called after placing a slab)
+template <int WD, int BT, int SH, bool SPLIT>
+void avalanche_down_k (int i, int j)   // avalanche down (called after placing a slab)
 {
     // declare variables
+    typedef bounds_policy<BT> B;
 	bool avidir[4] = {false, false, false, false};  // directions which a slab could fall from
     int avi_final;        							// final decision of avalanche direction
     // coordinates of boolean are referenced as: 0 = north, 1 = south, 2 = east, 3 = west
 
+    dirty_row[i] = true; dirty_col[j] = true;       // the surface just changed here, flag the lines
+
+    // ------------------------------------------------------------------------------
+    // Analysis add-in: fieldstats (a slab was just put on this cell)
+    wdune_fieldstats.update(surf[i][j] - 1, surf[i][j], bsmt_at(i, j));
+    // ------------------------------------------------------------------------------
+    cell_changed_k<SH> (i, j);                             // recheck whether the cell can erode
+
     // check the directions, check slope, no need to check availability because a slab was just deposited
     // look to the north
-    if (surf [i][j] - surf[i_n[i]][j] > avalanche_thresh)
+    if (surf [i][j] - surf[B::north(i)][j] > avalanche_thresh)
     {
         avidir[0] = true;
     }
     // look to the south
-    if (surf[i][j] - surf[i_s[i]][j] > avalanche_thresh)
+    if (surf[i][j] - surf[B::south(i)][j] > avalanche_thresh)
     {
         avidir[1] = true;
     }
     // look to the east
-    if (surf[i][j] - surf[i][j_e[j]] > avalanche_thresh)
+    if (surf[i][j] - surf[i][B::east(j)] > avalanche_thresh)
     {
         avidir[2] = true;
     }
     // look to the west
-    if (surf[i][j] - surf[i][j_w[j]] > avalanche_thresh)
+    if (surf[i][j] - surf[i][B::west(j)] > avalanche_thresh)
     {
         avidir[3] = true;
     }
@@ -741,7 +641,7 @@ void avalanche_down(int i, int j)   // avalanche down (called after placing a sl
         // break any ties and make a final decision
         do
         {
-            avi_final = genrand_int32() % 4;   // draw a random direction
+            avi_final = rng_int32() % 4;   // draw a random direction
         }
         while (!avidir[avi_final]);         // repeat until the direction is suitable for avalanche
 
@@ -750,58 +650,260 @@ void avalanche_down(int i, int j)   // avalanche down (called after placing a sl
 		// ------------------------------------------------------------------------------
 		// Analysis add-in: slablogger
 		wdune_slablogger.increment_avi(i, j, (avi_final + 1));
+		// Analysis add-in: fieldstats (the slab falls off this cell)
+		wdune_fieldstats.update(surf[i][j], surf[i][j] - 1, bsmt_at(i, j));
 		// ------------------------------------------------------------------------------
 
+        // ------------------------------------------------------------------------------
+        // Domain add-in: the slab falls onto another rank's strip, it lands there
+        if (SPLIT && dom_land_across(i, j, avi_final))
+        {
+            if (!defer_shadow) { shadupdate_k<WD, BT, SH, SPLIT> (i, j); }
+            return;
+        }
+        // ------------------------------------------------------------------------------
+
         // move slab to the north
         if (avi_final == 0)
         {
             surf[i][j]--;               // subtract the slab of sand
-            i = i_n[i];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls off
+            i = B::north(i);                 // reset the focal coordinates
             surf[i][j]++;               // add the slab of sand that avalanches
-            avalanche_down (i, j);      // call the function recursively
+            avalanche_down_k<WD, BT, SH, SPLIT> (i, j);      // call the function recursively
         }
         // move slab to the south
         if (avi_final == 1)
         {
             surf[i][j]--;               // subtract the slab of sand
-            i = i_s[i];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls off
+            i = B::south(i);                 // reset the focal coordinates
             surf[i][j]++;               // add the slab of sand that avalanches
-            avalanche_down (i, j);      // call the function recursively
+            avalanche_down_k<WD, BT, SH, SPLIT> (i, j);      // call the function recursively
         }
         // move slab to the east
         if (avi_final == 2)
         {
             surf[i][j]--;               // subtract the slab of sand
-            j = j_e[j];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls off
+            j = B::east(j);                 // reset the focal coordinates
             surf[i][j]++;               // add the slab of sand that avalanches
-            avalanche_down (i, j);      // call the function recursively
+            avalanche_down_k<WD, BT, SH, SPLIT> (i, j);      // call the function recursively
         }
         // move slab to the west
         if (avi_final == 3)
         {
             surf[i][j]--;               // subtract the slab of sand
-            j = j_w[j];                 // reset the focal coordinates
+            cell_changed_k<SH> (i, j);         // recheck the cell the slab falls off
+            j = B::west(j);                 // reset the focal coordinates
             surf[i][j]++;               // add the slab of sand that avalanches
-            avalanche_down (i, j);      // call the function recursively
+            avalanche_down_k<WD, BT, SH, SPLIT> (i, j);      // call the function recursively
         }
     }
-    // else, update the shadow
-    else
+    // else, update the shadow (unless the caller will sweep the dirty lines itself)
+    else if (!defer_shadow)
     {
-        shadupdate (i, j);         // run the shadupdate function
+        shadupdate_k<WD, BT, SH, SPLIT> (i, j);         // run the shadupdate function
+    }
+}
+
+template <int WD, int BT, int SH, bool SPLIT>
+void picksite_depo_k (int i, int j)    // pick a site to deposit
+{
+    bool foundSite = false;         // set flag denoting whether a site has been found
+    while (!foundSite)
+    {
+        // ------------------------------------------------------------------------
+		// Slablogger analysis add-in: call before moving coordinates!
+		wdune_slablogger.increment_trans(i, j);
+		// ------------------------------------------------------------------------
+
+		// reset i and j with the deposition lookup (move downwind)
+        if (WD != 5)            // cardinal: jump along the wind line only
+        {
+            if (line_policy<WD, BT>::cols) { i = i_dp[i]; } else { j = j_dp[j]; }
+        }
+        else if (obl_majj)      // oblique: jump along the major axis, shift along the minor axis
+        {
+            int i_next = obl_nwrap[i + obl_ddp[j] + obl_pad];
+            j = obl_mwrap[j + obl_mstep * depjump + obl_pad];
+            i = i_next;
+        }
+        else
+        {
+            int j_next = obl_nwrap[j + obl_ddp[i] + obl_pad];
+            i = obl_mwrap[i + obl_mstep * depjump + obl_pad];
+            j = j_next;
+        }
+
+		// if i or j is toxic, break the loop immediately, the site is off the model space
+        if (i == i_toxic || j == j_toxic)
+        {
+            i_depo = i; j_depo = j;
+            break;
+        }
+        		
+        // the slab has flown into another rank's strip, it lands there (see wdune_domain.hpp)
+        if (SPLIT && !dom_owns(i, j))
+        {
+            i_depo = i; j_depo = j;
+            break;
+        }
+
+        // now draw a random number and check the probability of depositing
+        if (rng_real1() < depo_prob_k<SH> (i, j))
+        {
+            i_depo = i; j_depo = j;   // set deposition coordinates
+            foundSite = true;         // a site was found, break the loop
+        }
     }
 }
 
+// kernels in use, see set_kernels
+void (*shadupdate)(int i, int j);       // update the shadow at a given site
+void (*avalanche_up)(int i, int j);     // avalanche up (called after picking up a slab)
+void (*avalanche_down)(int i, int j);   // avalanche down (called after placing a slab)
+void (*picksite_depo)(int i, int j);    // pick a site to deposit
+
+template <int WD, int BT, int SH, bool SPLIT>
+void use_kernels()                  // point the calls at the kernels for one wind, boundary type and mode
+{
+    shadupdate = shadupdate_k<WD, BT, SH, SPLIT>;
+    avalanche_up = avalanche_up_k<WD, BT, SH, SPLIT>;
+    avalanche_down = avalanche_down_k<WD, BT, SH, SPLIT>;
+    picksite_depo = picksite_depo_k<WD, BT, SH, SPLIT>;
+}
+
+template <int WD, int BT>
+void use_kernels_modes()            // pick the shadow mode and the split for one wind and boundary type
+{
+    // an oblique wind is always swept on one rank, so it only needs the first
+    if (shadow_mode == 1) { use_kernels<WD, BT, (WD == 5) ? 0 : 1, false>(); }
+    else if (nranks > 1) { use_kernels<WD, BT, 0, WD != 5>(); }
+    else { use_kernels<WD, BT, 0, false>(); }
+}
+
+template <int WD>
+void use_kernels_bounds()           // pick the boundary type for one wind
+{
+    if (bound_type == 1) { use_kernels_modes<WD, 1>(); }
+    if (bound_type == 2) { use_kernels_modes<WD, 2>(); }
+    if (bound_type == 3) { use_kernels_modes<WD, 3>(); }
+    if (bound_type == 4) { use_kernels_modes<WD, 4>(); }
+}
+
+void set_kernels()                  // set the kernels for the present wind and boundary type
+{
+    if (wdir == 1) { use_kernels_bounds<1>(); }
+    if (wdir == 2) { use_kernels_bounds<2>(); }
+    if (wdir == 3) { use_kernels_bounds<3>(); }
+    if (wdir == 4) { use_kernels_bounds<4>(); }
+    if (wdir == 5) { use_kernels_bounds<5>(); }
+}
+
+void init_shadupdate()              // set shadow update for the first time
+{
+    // lazy shadow: build the trees of the wind lines instead
+    if (shadow_mode == 1)
+    {
+        env_build();
+        if (tile_mode) { tile_refresh_all(); }
+        return;
+    }
+
+    // first set the shadow to be identical to the present topography
+    for (int i = 0; i < nrows; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            shad[i][j] = surf [i][j];
+        }
+    }
+
+    // update the shadow with the shadupdate function, once for every wind line
+    if (wdir == 5) // oblique
+    {
+        oblique_init_shadupdate();
+        if (tile_mode) { tile_refresh_all(); }
+    }
+
+    if (wdir == 1 || wdir == 2) // northerly and southerly: the lines are columns
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            shadupdate(0, j);
+        }
+    }
+
+    if (wdir == 3 || wdir == 4) // easterly and westerly: the lines are rows
+    {
+        for (int i = 0; i < nrows; i++)
+        {
+            shadupdate(i, 0);
+        }
+    }
+}
+
+void dirty_shadupdate()             // re-sweep only the lines flagged as dirty
+{
+    /*
+    Gives the same shadow as init_shadupdate, as the shadow along a wind line only depends
+    on the surface along that line, and every line that is not flagged has been swept
+    since it last changed.
+    */
+    if (shadow_mode == 1)           // lazy shadow: always up to date
+    {
+        return;
+    }
+    if (wdir == 1 || wdir == 2)     // wind lines are columns
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            if (dirty_col[j])
+            {
+                shadupdate(0, j);
+            }
+        }
+    }
+    if (wdir == 3 || wdir == 4)     // wind lines are rows
+    {
+        for (int i = 0; i < nrows; i++)
+        {
+            if (dirty_row[i])
+            {
+                shadupdate(i, 0);
+            }
+        }
+    }
+    if (wdir == 5)                  // oblique wind lines cross rows and columns, update everything
+    {
+        init_shadupdate();
+    }
+}
+
+void add_sand(int i, int j)         // add a slab of new sand at a site
+{
+    if (!dom_owns(i, j))
+    {
+        dom_send(dom_land, i, j, 0, 0, 0);      // the site is on another rank's strip
+        return;
+    }
+    surf[i][j]++;                   // add a slab
+    avalanche_down(i, j);           // avalanche down
+}
+
 void newSandEngine()                // add new sand to the modelspace
 {
     // declare variables
     int sandType, sandSide, lpcntr, i, j;
 
-    if (newSandCode !=0)      // allow quick exit from function if no new sand
+    // allow quick exit from function if no new sand, source maps (type 3) are run by supplyEngine
+    if (newSandCode != 0 && newSandCode / 10 != 3)
     {
         // decompose the new sand code
         sandType = newSandCode / 10;
         sandSide = newSandCode % 10;
+        defer_shadow = true;        // the shadow is swept once at the end, not after every slab
 
         lpcntr = 0;    // reset the loop counter
         // point sources
@@ -812,8 +914,7 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = 0; j = ncols / 2;           // halfway along the edge (approx)
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -822,8 +923,7 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = (nrows - 1); j = ncols / 2; // halfway along the edge (approx)
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -832,8 +932,7 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = nrows / 2; j = (ncols - 1); // halfway along the edge (approx)
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -842,8 +941,7 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = nrows / 2; j = 0;           // halfway along the edge (approx)
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -855,9 +953,8 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = 0;
-                    j = genrand_int32() % ncols;    // random location on edge
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    j = rng_int32() % ncols;    // random location on edge
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -866,9 +963,8 @@ void newSandEngine()                // add new sand to the modelspace
                 while (lpcntr < newSandSlabs)
                 {
                     i = (nrows - 1);
-                    j = genrand_int32() % ncols;    // random location on edge
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    j = rng_int32() % ncols;    // random location on edge
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -876,10 +972,9 @@ void newSandEngine()                // add new sand to the modelspace
             {
                 while (lpcntr < newSandSlabs)
                 {
-                    i = genrand_int32() % nrows;    // random location on edge
+                    i = rng_int32() % nrows;    // random location on edge
                     j = (ncols - 1);
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
@@ -887,87 +982,17 @@ void newSandEngine()                // add new sand to the modelspace
             {
                 while (lpcntr < newSandSlabs)
                 {
-                    i = genrand_int32() % nrows;    // random location on edge
+                    i = rng_int32() % nrows;    // random location on edge
                     j = 0;
-                    surf[i][j]++;                   // add a slab
-                    avalanche_down(i, j);           // avalanche down
+                    add_sand(i, j);                 // add a slab
                     lpcntr++;                       // advance counter
                 }
             }
 
         }
-        init_shadupdate();    // force the shadow to be updated for the entire model
-    }
-}
-
-void picksite_ero()                 // pick a site to erode from
-{
-    // first sample a random location
-    int i = genrand_int32() % nrows;
-    int j = genrand_int32() % ncols;
-    /*
-	Conditions for erosion:
-        1) surface higher than basement
-        2) surface higher or equal to shadow (e.g., not in a shadow zone)
-    Notes:
-    This function is an if statement, rather than a while loop to allow
-    time to pass properly. If the conditions are assessed as part of a
-    while loop, time stands unnaturally still searching for a site for erosion.
-    */
-    if ((surf[i][j] > bsmt[i][j]) && (surf[i][j] >= shad[i][j]))
-    {
-        i_ero = i; j_ero = j;   // if conditions are met, set the erosion coordinates
-        ero_flag = true;        // set the flag high
-    }
-    else
-    {
-        ero_flag = false;       // else, no erosion this time, flag is low
-    }
-}
-
-void picksite_depo(int i, int j)    // pick a site to deposit
-{
-    double probCut;                 // set local probability cutoff
-    bool foundSite = false;         // set flag denoting whether a site has been found
-    while (!foundSite)
-    {
-        // ------------------------------------------------------------------------
-		// Slablogger analysis add-in: call before moving coordinates!
-		wdune_slablogger.increment_trans(i, j);
-		// ------------------------------------------------------------------------
-		
-		// if i or j is toxic, break the loop immediately, the site is off the model space
-        if (i == i_toxic || j == j_toxic)
-        {
-            i_depo = i; j_depo = j;
-            break;
-        }
-
-		// reset i and j with the deposition lookup (move downwind)
-        i = i_dp[i]; j = j_dp[j];
-        		
-		// calculate the probability of depositing
-        if (surf[i][j] < shad[i][j])
-        {
-            probCut = 1.0;
-        }
-        else        // else set the probability cutoff based on psand
-        {
-            if (surf[i][j] > bsmt[i][j])    // if surface greater than basement, there is sand
-            {
-                probCut = psand;
-            }
-            else				// else, there is no sand, set probability cutoff
-            {
-                probCut = pnosand;
-            }
-        }
-        // now draw a random number and check the probability cutoff
-        if (genrand_real1() < probCut)
-        {
-            i_depo = i; j_depo = j;   // set deposition coordinates
-            foundSite = true;         // a site was found, break the loop
-        }
+        slabs_in = slabs_in + lpcntr;     // keep track of the new sand for the mass balance
+        defer_shadow = false;
+        dirty_shadupdate();   // force the shadow to be updated wherever the new sand has touched
     }
 }
 
@@ -977,6 +1002,10 @@ void deposit(int i, int j)          // deposit sand at a site
     {
         slabs_out++;                // the slab got blown out of the modelspace
     }
+    else if (!dom_owns(i, j))
+    {
+        dom_send(dom_flight, i, j, 0, 0, 0);    // the slab lands on another rank's strip
+    }
     else
     {
         surf[i][j]++;               // deposit the sand
@@ -984,6 +1013,14 @@ void deposit(int i, int j)          // deposit sand at a site
     }
 }
 
+void erode_at(int i, int j)         // erode a slab off a site and carry it downwind (an erosion event of every engine)
+{
+    surf[i][j]--;                   // remove a slab off the erosion site
+    avalanche_up(i, j);             // avalanche up after removing the sand
+    picksite_depo(i, j);            // pick a site to deposit the sand
+    deposit(i_depo, j_depo);        // put a slab of sand onto the deposition site
+}
+
 
 
 
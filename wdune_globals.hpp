@@ -45,8 +45,8 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 
 // Global variables
 // constants
-const int maxNrow = 5000;
-const int maxNcol = 5000;
+const int max_ranks = 64;               // most processes the domain can be split over
+const int max_branches = 64;            // most continuation runs forked from one spin-up
 const int avalanche_thresh = 5;         
 /* 
 Avalanche threshold is set as constant in this implementation
@@ -61,21 +61,63 @@ int numIterations, bound_type, wdir, depjump, ncols, nrows;
 double dropdist, psand, pnosand;
 int newSandCode, newSandSlabs;
 
+double wind_azimuth = -1.0;                                     // wind azimuth for oblique winds (wdir = 5)
+
 // model operational variables
-int i_n[maxNrow], i_s[maxNrow], j_e[maxNcol], j_w[maxNcol];     // adjacent coordinate lookups
-int i_dp[maxNrow], j_dp[maxNcol];                               // deposition coordinate lookups
+int *i_n, *i_s, *j_e, *j_w;                                     // adjacent coordinate lookups
+int *i_dp, *j_dp;                                               // deposition coordinate lookups
 int i_ero, j_ero, i_depo, j_depo;                               // erosion and deposition coordinates
-int shadloops;                                                  // number of loops the shadow updater performs
+int shadloops;                                                  // number of loops the shadow updater performs (2 where the wind lines wrap around)
 bool ero_flag;                                                  // flag to indicate that erosion is happening
 int slabs_out = 0;                                              // number of slabs that fall of the edges
+int slabs_in = 0;                                               // number of slabs added as new sand
 int t = 0;                                                      // main iteration counter
+bool stop_run = false;                                          // flag to end the time loop early
+int engine = 0;                                                 // erosion sampler: 0 = polling, 1 = tile sampler, 2 = kinetic Monte Carlo
+int poll_ahead = 0;                                             // polls the polling engine prefetches ahead, see wdune_prefetch.hpp
+int huge_pages = 0;                                             // grids on huge pages: 0 = no, 1 = transparent, 2 = reserved pool, see wdune_grids.hpp
+int numa_local = 0;                                             // pin the ranks and place their strips on their own memory node
+int shadow_mode = 0;                                            // shadow: 0 = swept grid, 1 = lazy queries, see wdune_envelope.hpp
+int nranks = 1;                                                 // processes the domain is split over, see wdune_domain.hpp
+int sub_steps = 1;                                              // exchanges between the ranks per iteration
+int nbranches = 0;                                              // continuation runs forked from the spin-up, see wdune_branch.hpp
+int branch_at = 0;                                              // iteration at which the spin-up ends and the branches start
+int branch_id = 0;                                              // branch this process runs (0 = the spin-up)
+int run_seed = 0;                                               // fixed seed of the random numbers (0 = from the clock)
+int cache_every = 0;                                            // iterations between checkpoints in the spin-up cache, see wdune_cache.hpp
+int cache_mb = 1024;                                            // size limit of the spin-up cache on disk (MB)
+bool steady_on = false;                                         // steady state monitor switched on, see wdune_analysis.hpp
+int steady_window = 0;                                          // window of the monitor (iterations)
+double steady_tol[3] = {0.05, 0.05, 0.05};                      // relative tolerances of the flux, roughness and cover
+int steady_checks = 3;                                          // consecutive steady checks to stop the run
+bool morph_on = false;                                          // morphology analysis switched on
+int morph_interval = 0;                                         // iterations between morphology measurements
+int morph_threshold = 1;                                        // dune threshold (slabs above the mean height)
+bool spectrum_on = false;                                       // spectrum analysis switched on
+int spectrum_interval = 0;                                      // iterations between spectrum measurements
+bool defer_shadow = false;                                      // flag to hold back shadow updates during sand injection
+
+// oblique wind lookups (wdir = 5), see oblique_bounds
+bool obl_majj;                                                  // major axis of the wind is j (else i)
+int obl_mstep;                                                  // step along the major axis (+1 or -1)
+int obl_cardinal;                                               // cardinal direction sharing the major axis
+int obl_pad;                                                    // padding on the wrap lookups
+int * obl_d;                                                    // minor step leaving each major coordinate
+int * obl_ddp;                                                  // minor shift of a deposition jump from each major coordinate
+int * obl_mwrap;                                                // wrap lookup along the major axis (padded, -1 = off edge)
+int * obl_nwrap;                                                // wrap lookup along the minor axis (padded, -1 = off edge)
+double obl_drop;                                                // shadow drop per step along the wind line
 
-// model arrays
-int surf [maxNrow][maxNcol];
-int bsmt [maxNrow][maxNcol];
+// model arrays: the surface and wind shadow height grids are in wdune_grids.hpp, the basement is in wdune_basement.hpp
 
-// wind shadow height
-double shad [maxNrow][maxNcol];
+// dirty line flags: rows and columns whose surface has changed since their shadow was last swept
+bool * dirty_row;
+bool * dirty_col;
+/*
+Every surface change passes through avalanche_up or avalanche_down, which flag both the row
+and the column of the cell. The shadow updater clears the flag for the line it sweeps, so
+only the lines still flagged need to be re-swept to make the shadow exact again.
+*/
 
 // toxic coordinates: program will not deposit sand in these sites (effectively removing sand from modelspace)
 int i_toxic = -1;               
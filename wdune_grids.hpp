@@ -0,0 +1,343 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Grid storage: the model arrays in memory, or in memory mapped backing files
+/*
+The surface and shadow grids are allocated once the domain size is known, as one block per grid
+with a table of row pointers, so surf[i][j] reads the same wherever the block lives. By default
+the blocks are ordinary heap memory. If 'backing_dir.txt' (or backing_dir in the configuration
+file) names a directory, the blocks are instead files in that directory ('surf.bin', 'shad.bin',
+or 'env.bin' for the lazy shadow) mapped into the address space, so a domain larger than RAM
+pages in and out through the page cache. The basement has its own read only store
+(wdune_basement.hpp), which also goes in the backing directory.
+
+Layout: by default a block holds the rows one after the other, so the cells north and south of
+a cell are a whole row away, on another page once the grid is a thousand or so columns wide.
+Built with 'make GRID_TILE=B' (a power of two up to 64) the block is laid out in tiles of B by
+B cells instead, row by row within a tile and tile by tile along a band of B rows, padded out to
+whole tiles, so an avalanche or a deposition jump mostly stays within a tile or two. The grids
+are read through grid<T>: surf[i] gives the row (a pointer to where the row starts within its
+band) and [j] steps over the tiles to the column, so the code reads surf[i][j] in either layout,
+and the text files are read and written through it too, in row order. Row major is the same
+formula with B = 1. The tile edge is fixed when building: as a variable the shift and mask have
+to be read again after every store to a grid, which cost a fifth of the run time in row major.
+
+Tiles pay off where the shadow is swept down the columns (north and south winds): on a 1000 by
+1000 field one iteration took 23 s with 8 by 8 tiles against 33 s in row major. Sweeps along the
+rows (east and west winds) and the lazy shadow run 10 to 20 % slower in tiles, so row major stays
+the default.
+
+Huge pages: random access over hundreds of MB misses the TLB on almost every poll with 4 KB pages.
+With 'huge_pages = thp' in the configuration file the in memory blocks are mapped on 2 MB
+boundaries and advised for transparent huge pages, with 'huge_pages = explicit' they are taken
+from the reserved huge page pool (vm.nr_hugepages), falling back to transparent huge pages and
+then to the ordinary heap when there is not enough of it. What was actually obtained is read
+back from /proc/self/smaps once the grids are filled and printed (grid_huge_report). Grids mapped
+from backing files stay on ordinary pages.
+
+Either way each band of rows (tile_rows) is one contiguous run of the file. With the tile
+sampler running, the bands that hold erodible cells are where the erosion happens: those are
+advised as needed soon and bands with no erodible cells as cold, refreshed every iteration
+(tile_advise). The hints only change paging, never the results.
+*/
+
+// grid layout
+#ifndef GRID_TILE
+#define GRID_TILE 1                 // edge of the layout tiles (1 = row major), set with make GRID_TILE=B
+#endif
+#if GRID_TILE != 1 && GRID_TILE != 2 && GRID_TILE != 4 && GRID_TILE != 8 && GRID_TILE != 16 && GRID_TILE != 32 && GRID_TILE != 64
+#error "GRID_TILE must be 1, 2, 4, 8, 16, 32 or 64"
+#endif
+const int grid_shift = (GRID_TILE >= 64) ? 6 : (GRID_TILE >= 32) ? 5 : (GRID_TILE >= 16) ? 4 :
+    (GRID_TILE >= 8) ? 3 : (GRID_TILE >= 4) ? 2 : (GRID_TILE >= 2) ? 1 : 0;    // log2 of the tile edge
+const int grid_mask = (1 << grid_shift) - 1;                                    // tile edge - 1
+int grid_pcols;                     // columns, padded out to whole tiles
+int grid_prows;                     // rows, padded out to whole tiles
+
+template <class T> struct grid_row  // a row of a grid
+{
+    T * p;                          // where the row starts, within the first tile it runs through
+    inline T & operator[](int j) const
+    {
+        return p[((j & ~grid_mask) << grid_shift) + (j & grid_mask)];
+    }
+};
+
+template <class T> struct grid      // a grid, read as g[i][j] in either layout
+{
+    T ** rows;                      // row starts
+    inline grid_row<T> operator[](int i) const
+    {
+        grid_row<T> r = {rows[i]};
+        return r;
+    }
+};
+
+// model arrays
+grid<int> surf;                     // surface height
+grid<double> shad;                  // wind shadow height
+
+// grid storage variables
+bool grid_mapped = false;           // are the grids mapped from backing files
+char grid_dir[1024];                // directory of the backing files
+size_t grid_page;                   // page size, for aligning the hints
+int * surf_data;                    // the grid blocks behind the row pointers
+double * shad_data;
+int * env_data;                     // the lazy shadow trees, in place of the shadow (wdune_envelope.hpp)
+
+// huge page variables
+const size_t grid_huge = 2 * 1024 * 1024;      // huge page size
+int grid_nhuge = 0;                 // number of blocks allocated by grid_alloc
+char * grid_huge_at[3];             // the blocks
+size_t grid_huge_len[3];            // their lengths
+bool grid_huge_explicit[3];         // taken from the reserved pool
+
+void grid_path(char * path, const char * name)     // path of a backing file (path holds 1100 chars)
+{
+    snprintf (path, 1100, "%s/%s", grid_dir, name);
+}
+
+void * grid_map(const char * name, size_t bytes)   // map a backing file of the given size
+{
+    char path[1100];
+    grid_path (path, name);
+    int fd = open (path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate (fd, bytes) != 0)
+    {
+        cout << "ERROR WITH BACKING FILE: " << path << endl;
+        exit (11);
+    }
+    void * p = mmap (NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);                     // the mapping keeps the file open
+    if (p == MAP_FAILED)
+    {
+        cout << "CANNOT MAP BACKING FILE: " << path << endl;
+        exit (10);
+    }
+    return p;
+}
+
+template <class T> grid<T> grid_rows(T * data)     // row pointers into a grid block
+{
+    grid<T> g;
+    g.rows = new T * [nrows];
+    for (int i = 0; i < nrows; i++)
+    {
+        g.rows[i] = data + (size_t)(i & ~grid_mask) * grid_pcols + ((i & grid_mask) << grid_shift);
+    }
+    return g;
+}
+
+void * grid_alloc(size_t bytes)     // allocate an in memory grid block, on huge pages if asked for
+{
+    size_t len = (bytes + grid_huge - 1) / grid_huge * grid_huge;
+    char * p;
+    if (huge_pages == 0)
+    {
+        return new char [bytes];    // ordinary heap
+    }
+    grid_huge_len[grid_nhuge] = len;
+    grid_huge_explicit[grid_nhuge] = false;
+#ifdef MAP_HUGETLB
+    if (huge_pages == 2)            // the reserved pool
+    {
+        p = (char *)mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            grid_huge_explicit[grid_nhuge] = true;
+            grid_huge_at[grid_nhuge++] = p;
+            return p;
+        }
+    }
+#endif
+    // transparent huge pages: map a huge page more than needed and keep the part on 2 MB boundaries
+    p = (char *)mmap (NULL, len + grid_huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        return new char [bytes];    // leave it to the heap (which throws if there is no memory at all)
+    }
+    size_t lead = (grid_huge - (size_t)p % grid_huge) % grid_huge;
+    if (lead > 0)
+    {
+        munmap (p, lead);
+    }
+    munmap (p + lead + len, grid_huge - lead);
+    p = p + lead;
+#ifdef MADV_HUGEPAGE
+    madvise (p, len, MADV_HUGEPAGE);
+#endif
+    grid_huge_at[grid_nhuge++] = p;
+    return p;
+}
+
+void grid_huge_report()             // print how much of the grids is on huge pages (after they are filled)
+{
+    FILE *pMaps;
+    char line[512];
+    unsigned long lo = 0, hi = 0, kb;
+    double total = 0.0, got = 0.0, pool = 0.0, mb = 1024.0 * 1024.0;
+    bool in = false;
+
+    if (huge_pages == 0 || grid_nhuge == 0)
+    {
+        return;
+    }
+    for (int b = 0; b < grid_nhuge; b++)
+    {
+        total = total + grid_huge_len[b];
+        if (grid_huge_explicit[b])
+        {
+            pool = pool + grid_huge_len[b];     // the pool is reserved whole at the mapping
+        }
+    }
+    // transparent huge pages: add up AnonHugePages over the mappings of the blocks
+    pMaps = fopen ("/proc/self/smaps", "r");
+    while (pMaps != NULL && fgets (line, sizeof (line), pMaps) != NULL)
+    {
+        if (sscanf (line, "%lx-%lx", &lo, &hi) == 2 && strchr (line, '-') < strchr (line, ' '))
+        {
+            in = false;
+            for (int b = 0; b < grid_nhuge; b++)
+            {
+                in = in || (!grid_huge_explicit[b] && lo < (unsigned long)(grid_huge_at[b] + grid_huge_len[b])
+                    && hi > (unsigned long)grid_huge_at[b]);
+            }
+        }
+        else if (in && sscanf (line, "AnonHugePages: %lu kB", &kb) == 1)
+        {
+            got = got + kb * 1024.0;
+        }
+    }
+    if (pMaps != NULL)
+    {
+        fclose (pMaps);
+    }
+    cout << "Huge pages: " << (got + pool) / mb << " of " << total / mb << " MB of the grids";
+    if (huge_pages == 2)
+    {
+        cout << ", " << pool / mb << " MB from the reserved pool";
+    }
+    cout << ((got + pool == 0.0) ? " (none obtained, running on ordinary pages)" : "") << endl;
+}
+
+void alloc_grids()                  // allocate the lookups, flags and grids for the domain
+{
+    // the layout: tiles of GRID_TILE by GRID_TILE cells (1 = row major), padded out to whole tiles
+    grid_prows = (nrows + grid_mask) & ~grid_mask;
+    grid_pcols = (ncols + grid_mask) & ~grid_mask;
+    size_t cells = (size_t)grid_prows * grid_pcols;
+
+    // read the backing directory, if there is one
+    FILE *pDir = config_has ("backing_dir") ? NULL : fopen ("backing_dir.txt", "r");
+    if (pDir != NULL)
+    {
+        grid_mapped = (fscanf (pDir, "%1023s", grid_dir) == 1);
+        fclose (pDir);
+    }
+    if (config_has ("backing_dir"))
+    {
+        snprintf (grid_dir, sizeof (grid_dir), "%s", config_str ("backing_dir"));
+        grid_mapped = true;
+    }
+
+    try {
+        i_n = new int [nrows];
+        i_s = new int [nrows];
+        i_dp = new int [nrows];
+        j_e = new int [ncols];
+        j_w = new int [ncols];
+        j_dp = new int [ncols];
+        dirty_row = new bool [nrows];
+        dirty_col = new bool [ncols];
+        if (grid_mapped)
+        {
+            surf_data = (int *)grid_map ("surf.bin", cells * sizeof (int));
+            if (shadow_mode == 0) { shad_data = (double *)grid_map ("shad.bin", cells * sizeof (double)); }
+            else { env_data = (int *)grid_map ("env.bin", (size_t)nrows * ncols * sizeof (int)); }
+        }
+        else
+        {
+            surf_data = (int *)grid_alloc (cells * sizeof (int));
+            if (shadow_mode == 0) { shad_data = (double *)grid_alloc (cells * sizeof (double)); }
+            else { env_data = (int *)grid_alloc ((size_t)nrows * ncols * sizeof (int)); }
+        }
+        surf = grid_rows (surf_data);
+        if (shadow_mode == 0) { shad = grid_rows (shad_data); }
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    for (int i = 0; i < nrows; i++)
+    {
+        dirty_row[i] = false;
+    }
+    for (int j = 0; j < ncols; j++)
+    {
+        dirty_col[j] = false;
+    }
+    for (size_t x = 0; shadow_mode == 0 && x < cells; x++)
+    {
+        shad_data[x] = 0.0;
+    }
+
+    if (grid_mapped)
+    {
+        grid_page = sysconf (_SC_PAGESIZE);
+        cout << "Grids mapped from backing files in " << grid_dir << endl;
+    }
+    if (grid_mask > 0)
+    {
+        cout << "Grid layout: tiles of " << grid_mask + 1 << " by " << grid_mask + 1 << " cells" << endl;
+    }
+}
+
+void grid_advise_rows(void * data, size_t cell, int i0, int i1, int advice)    // advise the pages of rows i0 to i1 - 1 of a grid
+{
+    size_t start = (size_t)(i0 & ~grid_mask) * grid_pcols * cell;     // whole bands of tiles
+    size_t end = (size_t)((i1 + grid_mask) & ~grid_mask) * grid_pcols * cell;
+    start = start - start % grid_page;      // the blocks start on a page, so align within them
+    madvise ((char *)data + start, end - start, advice);
+}
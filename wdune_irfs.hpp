@@ -48,12 +48,12 @@ assistance if you wish to extend the program (tom.barchyn@uleth.ca).
 
 void init_wdune()  // initialization
 {
-    FILE *pSurf, *pBsmt;
+    FILE *pSurf;
 
     // seed the random number generator
     timeval tm;
     gettimeofday(&tm, NULL);
-    init_genrand (tm.tv_usec);  // seed mersenne twister with milliseconds
+    rng_seed ((run_seed > 0) ? run_seed : tm.tv_usec);     // seed mersenne twister with the fixed seed, or milliseconds
 
     // print arguments to console
     cout << "Core release: 28 October 2011" << endl;
@@ -61,6 +61,7 @@ void init_wdune()  // initialization
     cout << "Arguments passed to core:"
         << "\n    Iterations = " << numIterations
         << "\n    Wind direction = " << wdir
+        << "\n    Wind azimuth = " << wind_azimuth
         << "\n    Deposition jump = " << depjump
         << "\n    P Sand = " << psand
         << "\n    P Basement = " << pnosand
@@ -71,6 +72,8 @@ void init_wdune()  // initialization
         << "\n    New sand code = " << newSandCode
         << "\n    New sand slabs = " << newSandSlabs << endl;
 
+    alloc_grids();          // size the grids to the domain
+
     // read in the input files
     // topography
     int scan;       // dummy variable to store return values
@@ -85,55 +88,99 @@ void init_wdune()  // initialization
     fclose (pSurf);
 
     // basement
-    pBsmt = fopen ("bsmt.txt", "r");
-    for (int i = 0; i < nrows; i++)
-    {
-        for (int j = 0; j < ncols; j++)
-        {
-            scan = fscanf (pBsmt, "%d", &bsmt[i][j]);
-        }
-    }
-    fclose (pBsmt);
+    init_basement();
 
     // set the boundary lookups
-    if (bound_type == 1) { nonperiodic_bounds(); }
-    if (bound_type == 2) { periodic_bounds(); }
-    if (bound_type == 3) { nonperiodic_bounds_EW(); }
-    if (bound_type == 4) { nonperiodic_bounds_NS(); }
-	
+    set_bounds();
+    init_wind();            // read the wind schedule, if there is one, and set up the first regime
+    set_kernels();          // compiled kernels for the wind and boundaries
+
+    init_cache();           // restore the latest checkpoint of this run, if there is a cache
     init_shadupdate();      // update the shadow for the first time
+    if (engine == 1 || engine == 2) { init_tiles(); }     // set up the erodible cell set once the shadow is there
+    grid_huge_report();     // how much of the grids is on huge pages, if they were asked for
+    init_supply();          // read the source map, if new sand comes from one
 	init_analysis();		// initialize any analysis functions
+    init_ranks();           // split the domain over the ranks, if asked for
+    init_branches();        // read the branches to fork after the spin-up, if asked for
 	
-    cout << "Initialization complete . . entering time loop" << endl;
+    if (dom_rank == 0)
+    {
+        cout << "Initialization complete . . entering time loop" << endl;
+    }
 }
 
 void run_wdune()   // run
 {
     int t_poll = 0;                         // poll counter variable
-    while (t_poll < (ncols * nrows))
+    if (branch_update())                    // spin-up done: the branches have run on from here
+    {
+        return;
+    }
+    cache_update();                         // take a checkpoint if this is a milestone
+    wind_update();                          // change the wind if the schedule says so
+    tile_advise();                          // paging hints for mapped grids
+    if (nranks > 1)                         // split domain: this rank runs its own strip
+    {
+        dom_run();
+        return;
+    }
+    if (engine == 1)                        // tile sampler: skip straight to the polls that find erodible cells
+    {
+        while (tile_total > 0)
+        {
+            t_poll = t_poll + tile_skip();      // polls up to and including the next successful one
+            if (t_poll > (ncols * nrows))
+            {
+                break;                          // the next erosion falls in the next iteration
+            }
+            tile_pick(i_ero, j_ero);            // pick the erodible site
+            erode_at(i_ero, j_ero);             // erode the site and carry the slab downwind
+        }
+    }
+    if (engine == 2)                        // kinetic Monte Carlo: continuous clock over the erodible cells
+    {
+        /*
+        Every cell is polled once per iteration on average, so each erodible cell erodes at a rate
+        of one per iteration and the waiting time to the next erosion anywhere is exponential with
+        rate E (the number of erodible cells). Events before the clock reaches t + 1 belong to this
+        iteration; the waiting time is memoryless, so the one that crosses is dropped and the next
+        iteration draws afresh.
+        */
+        double clock = t;                   // continuous time, in iterations
+        while (tile_total > 0)
+        {
+            clock = clock - log (rng_real3()) / tile_total;     // time of the next erosion
+            if (clock >= t + 1)
+            {
+                break;                          // the next erosion falls in the next iteration
+            }
+            tile_pick(i_ero, j_ero);            // pick the erodible site
+            erode_at(i_ero, j_ero);             // erode the site and carry the slab downwind
+        }
+    }
+    while (engine == 0 && t_poll < (ncols * nrows))
     {
+        poll_prefetch();                    // prefetch the cells of the polls ahead, if asked for
         picksite_ero();                     // pick a site to erode from
         if (ero_flag)                       // flag is true if the site is good for erosion
         {
-            surf[i_ero][j_ero]--;               // remove a slab off the erosion site
-            avalanche_up(i_ero, j_ero);         // avalanche up after removing the sand
-            picksite_depo(i_ero, j_ero);        // pick a site to deposit the sand
-            deposit(i_depo, j_depo);            // put a slab of sand onto the deposition site
+            erode_at(i_ero, j_ero);             // erode the site and carry the slab downwind
         }
         t_poll++;                           // advance the poll counter
     }
     newSandEngine();                        // add some new sand if required
-	analyze_wdune();						// operate any analysis at end of iteration
+    supplyEngine();                         // add new sand from the source map if required
+    if (!branch_forked)
+    {
+        analyze_wdune();                    // operate any analysis at end of iteration (the spin-up only, with branches)
+    }
 }
 
-void final_wdune()     // finalization
+void write_surf(const char * name)  // write the surface array to a file
 {
-    cout << "Exiting time loop . . finalization beginning" << endl;
-    cout << "Number of slabs that were transported out of modelspace: " << slabs_out << endl;
     FILE *pSurf;
-
-    // write out the surface array, overwrite what was there originally
-    pSurf = fopen ("surf.txt", "w");
+    pSurf = fopen (name, "w");
     for (int i = 0; i < nrows; i++)
     {
         for (int j = 0; j < (ncols - 2); j++)
@@ -145,7 +192,32 @@ void final_wdune()     // finalization
         fprintf (pSurf, "%s", "\n");    // endline character
     }
     fclose (pSurf);
-	final_analysis();					// clean up any analysis functions
+}
+
+void final_wdune()     // finalization
+{
+    char name[64];
+    final_ranks();          // gather the ranks of a split domain on rank 0
+    cout << "Exiting time loop . . finalization beginning" << endl;
+    cout << "Number of slabs that were transported out of modelspace: " << slabs_out << endl;
+
+    final_cache();          // take a checkpoint of the end of the run
+
+    // write out the surface array, overwrite what was there originally
+    if (branch_id > 0)
+    {
+        snprintf (name, sizeof (name), "surf_b%d.txt", branch_id);
+        write_surf (name);  // a branch writes its own surface
+    }
+    else
+    {
+        write_surf ("surf.txt");
+    }
+    final_branches();       // check the mass balance of a branch
+    if (nranks == 1 && !branch_forked)
+    {
+        final_analysis();   // clean up any analysis functions
+    }
     cout << "Finalization complete" << endl;
 }
 
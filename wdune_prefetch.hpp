@@ -0,0 +1,90 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Poll pipeline: prefetch the cells of the polls ahead in the polling engine
+/*
+Every poll of the polling engine reads the surface (and the shadow) at a random cell, and on
+grids larger than the cache each read is a miss the core waits on. The cells of the polls ahead
+are known in advance: a poll that finds nothing to erode draws two numbers from the generator and
+nothing else, so the next polls take their cells from the next numbers of the stream. With
+'poll_ahead = K' in the configuration file the engine reads those numbers from the block the
+generator has made without drawing them (rng_out, see wdune_random.hpp) and prefetches the
+surface of the cells of the next K polls while it works on the present one. Only the surface:
+the shadow is read for cells with sand alone and the deposition site for erosions alone, and
+prefetching those for every poll costs more memory traffic than it saves on fields that are
+mostly bare (16 ahead is a good start).
+
+The polls themselves still run one at a time from the generator, so the run is slab for slab the
+same as without the pipeline. An erosion draws more numbers and moves the polls ahead along the
+stream; the pipeline sees the stream was not where it expected and starts again from there. The
+look ahead stops at the end of the block of numbers the generator has made (624 numbers), it is
+only refilled when the next number is drawn.
+*/
+
+// poll pipeline variables
+int poll_mark = 0;                  // position in the generator block up to which the polls are prefetched
+int poll_next = -1;                 // position the generator should be at for the next poll
+
+void poll_prefetch()                // prefetch the cells of the polls ahead (called before each poll)
+{
+    int i, j;
+    if (poll_ahead == 0)            // allow quick exit from function if there is no pipeline
+    {
+        return;
+    }
+    if (rng_i != poll_next)         // an erosion or a new block moved the stream, start again from here
+    {
+        poll_mark = rng_i;
+    }
+    poll_next = rng_i + 2;          // where the stream will be if this poll finds nothing
+    while (poll_mark < rng_i + 2 * poll_ahead && poll_mark + 1 < N)
+    {
+        // the cell, as picksite_ero draws it
+        i = dom_i0 + rng_out[poll_mark] % dom_ni;
+        j = dom_j0 + rng_out[poll_mark + 1] % dom_nj;
+        poll_mark = poll_mark + 2;
+        __builtin_prefetch (&surf[i][j]);
+    }
+}
@@ -0,0 +1,162 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Bulk random numbers: the Mersenne Twister stream, made a block at a time into a buffer
+/*
+The model draws several numbers for every slab event and genrand_int32 makes them one at a time:
+a test for the end of the block, a load from the state and four tempering steps per number. The
+bulk generator makes the same stream (MT19937, seeded by init_genrand, see mersenne_twister.h)
+a whole block of 624 numbers at a time with vector operations, four numbers per step for the
+state recurrence and for the tempering, into an aligned buffer. A draw is then a load from the
+buffer at a cursor. The numbers are the very same as the ones genrand_int32 gives for the same
+seed, so a run is slab for slab the same as with the scalar generator.
+
+The recurrence of the state is new[k] = f(old[k], old[k + 1], new-or-old[k + 397]): the first
+227 words take the third term from the old state and the rest from the new words 227 places
+back, so four neighbouring words never depend on each other and can be made together.
+*/
+
+typedef unsigned int rng_vec __attribute__ ((vector_size (16)));    // four 32 bit words
+
+// bulk generator variables
+unsigned int rng_state[N] __attribute__ ((aligned (16)));   // state of the generator
+unsigned int rng_out[N] __attribute__ ((aligned (16)));     // tempered numbers of the present block
+int rng_i = N + 1;                  // cursor: position of the next number in the block (N + 1 = not seeded)
+
+inline rng_vec rng_load(const unsigned int * p)    // four words from any position
+{
+    rng_vec v;
+    memcpy (&v, p, sizeof (v));
+    return v;
+}
+
+inline rng_vec rng_step(rng_vec a, rng_vec b, rng_vec c)     // the recurrence on four words: a = old[k], b = old[k + 1], c = the word M on
+{
+    rng_vec y = (a & UPPER_MASK) | (b & LOWER_MASK);
+    return c ^ (y >> 1) ^ ((-(y & 1U)) & MATRIX_A);
+}
+
+inline unsigned int rng_step1(unsigned int a, unsigned int b, unsigned int c)  // the same on one word
+{
+    unsigned int y = (a & UPPER_MASK) | (b & LOWER_MASK);
+    return c ^ (y >> 1) ^ ((-(y & 1U)) & MATRIX_A);
+}
+
+void rng_seed(unsigned long s)      // seed the generator (as init_genrand)
+{
+    init_genrand (s);
+    for (int k = 0; k < N; k++)
+    {
+        rng_state[k] = (unsigned int)mt[k];
+    }
+    rng_i = N;                      // the first draw makes the first block
+}
+
+void rng_fill()                     // make the next block of numbers
+{
+    const int head = (N - M) / 4 * 4;                       // end of the vector steps of the first part
+    const int tail = (N - M) + (M - 1) / 4 * 4;             // end of the vector steps of the second part
+    int kk;
+    rng_vec v;
+    if (rng_i == N + 1)             // if rng_seed has not been called, a default seed is used (as genrand_int32)
+    {
+        rng_seed (5489UL);
+    }
+    for (kk = 0; kk < head; kk += 4)
+    {
+        v = rng_step (rng_load (&rng_state[kk]), rng_load (&rng_state[kk + 1]), rng_load (&rng_state[kk + M]));
+        memcpy (&rng_state[kk], &v, sizeof (v));
+    }
+    for (kk = head; kk < N - M; kk++)
+    {
+        rng_state[kk] = rng_step1 (rng_state[kk], rng_state[kk + 1], rng_state[kk + M]);
+    }
+    for (kk = N - M; kk < tail; kk += 4)
+    {
+        v = rng_step (rng_load (&rng_state[kk]), rng_load (&rng_state[kk + 1]), rng_load (&rng_state[kk + (M - N)]));
+        memcpy (&rng_state[kk], &v, sizeof (v));
+    }
+    for (kk = tail; kk < N - 1; kk++)
+    {
+        rng_state[kk] = rng_step1 (rng_state[kk], rng_state[kk + 1], rng_state[kk + (M - N)]);
+    }
+    rng_state[N - 1] = rng_step1 (rng_state[N - 1], rng_state[0], rng_state[M - 1]);
+
+    // tempering, as in genrand_int32
+    for (kk = 0; kk < N; kk += 4)
+    {
+        v = rng_load (&rng_state[kk]);
+        v ^= (v >> 11);
+        v ^= (v << 7) & 0x9d2c5680U;
+        v ^= (v << 15) & 0xefc60000U;
+        v ^= (v >> 18);
+        memcpy (&rng_out[kk], &v, sizeof (v));
+    }
+    rng_i = 0;
+}
+
+inline unsigned int rng_int32()     // a number on [0, 0xffffffff], as genrand_int32
+{
+    if (rng_i >= N)
+    {
+        rng_fill();
+    }
+    return rng_out[rng_i++];
+}
+
+inline double rng_real1()           // a number on [0, 1], as genrand_real1
+{
+    return rng_int32() * (1.0 / 4294967295.0);
+}
+
+inline double rng_real2()           // a number on [0, 1), as genrand_real2
+{
+    return rng_int32() * (1.0 / 4294967296.0);
+}
+
+inline double rng_real3()           // a number on (0, 1), as genrand_real3
+{
+    return (((double)rng_int32()) + 0.5) * (1.0 / 4294967296.0);
+}
@@ -0,0 +1,308 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Sediment supply engine: new sand from a source map and a supply time series
+/*
+This is switched on with a new sand code of 30. The spatial pattern of the supply is read from
+'supply_map.txt' (space separated grid of non-negative weights, same layout as 'surf.txt'), and
+the supply rate through time from 'supply_series.txt' (optional). Each line of the series is an
+iteration and a rate (slabs per iteration, may be fractional) that applies from that iteration
+until the next line. Without the series file, the rate is the new sand slabs argument.
+
+Source cells are sampled with an alias table (Walker 1977, Vose 1991), which costs two random
+draws per slab regardless of the number of source cells. The slabs for an iteration are drawn
+first, gathered per cell, and then placed and avalanched cell by cell with the shadow held back
+until the whole batch is in.
+*/
+
+// supply variables
+int supply_n = 0;               // number of source cells (cells with non-zero weight)
+int * supply_cell;              // grid index of each source cell (i * ncols + j)
+double * supply_prob;           // alias table: probability of keeping the drawn cell
+int * supply_alias;             // alias table: the cell to take otherwise
+int * supply_count;             // slabs drawn for each source cell in the present batch
+int * supply_touched;           // source cells drawn in the present batch
+
+int supply_nseries = 0;         // number of lines in the supply time series
+int * supply_series_t;          // iteration at which each rate starts
+double * supply_series_rate;    // slabs per iteration
+int supply_cursor = 0;          // present line of the supply time series
+double supply_carry = 0.0;      // fractional slabs carried over to the next iteration
+
+void build_alias(double * weights, int n)     // build the alias table from the source weights
+{
+    double total = 0.0;
+    int * work;                 // small stack grows from the start, large stack from the end
+    int n_small = 0, n_large = 0;
+    int s, l;
+
+    try {
+        work = new int [n];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        total = total + weights[k];
+    }
+    // scale the weights so the mean is 1, and sort into small and large
+    for (int k = 0; k < n; k++)
+    {
+        supply_prob[k] = weights[k] * n / total;
+        if (supply_prob[k] < 1.0)
+        {
+            work[n_small] = k; n_small++;
+        }
+        else
+        {
+            n_large++; work[n - n_large] = k;
+        }
+    }
+    // pair each small cell with a large cell that tops it up
+    while (n_small > 0 && n_large > 0)
+    {
+        n_small--; s = work[n_small];
+        l = work[n - n_large]; n_large--;
+        supply_alias[s] = l;
+        supply_prob[l] = supply_prob[l] + supply_prob[s] - 1.0;
+        if (supply_prob[l] < 1.0)
+        {
+            work[n_small] = l; n_small++;
+        }
+        else
+        {
+            n_large++;          // put it back on the large stack
+        }
+    }
+    // anything left over is full (within round off)
+    while (n_small > 0)
+    {
+        n_small--; supply_prob[work[n_small]] = 1.0; supply_alias[work[n_small]] = work[n_small];
+    }
+    while (n_large > 0)
+    {
+        supply_prob[work[n - n_large]] = 1.0; supply_alias[work[n - n_large]] = work[n - n_large];
+        n_large--;
+    }
+    delete [] work;
+}
+
+void init_supply()                  // read the source map and supply series
+{
+    FILE *pMap, *pSeries;
+    double * weights;
+    double w;
+    int scan;
+
+    if (newSandCode / 10 != 3)      // only used with the source map new sand code
+    {
+        return;
+    }
+
+    pMap = fopen ("supply_map.txt", "r");
+    if (pMap == NULL)
+    {
+        cout << "CANNOT OPEN supply_map.txt" << endl;
+        exit (11);
+    }
+    try {
+        weights = new double [nrows * ncols];
+        supply_cell = new int [nrows * ncols];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    // keep only the cells that supply sand
+    for (int i = 0; i < nrows; i++)
+    {
+        for (int j = 0; j < ncols; j++)
+        {
+            scan = fscanf (pMap, "%lf", &w);
+            if (scan != 1 || w < 0.0)
+            {
+                cout << "ERROR READING supply_map.txt AT ROW " << i << " COLUMN " << j << endl;
+                exit (11);
+            }
+            if (w > 0.0)
+            {
+                weights[supply_n] = w;
+                supply_cell[supply_n] = i * ncols + j;
+                supply_n++;
+            }
+        }
+    }
+    fclose (pMap);
+    if (supply_n == 0)
+    {
+        cout << "ERROR: supply_map.txt HAS NO SOURCE CELLS" << endl;
+        exit (11);
+    }
+
+    try {
+        supply_prob = new double [supply_n];
+        supply_alias = new int [supply_n];
+        supply_count = new int [supply_n];
+        supply_touched = new int [supply_n];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    build_alias(weights, supply_n);
+    delete [] weights;
+    for (int k = 0; k < supply_n; k++)
+    {
+        supply_count[k] = 0;
+    }
+
+    // the supply series is optional, count the lines and then read them
+    pSeries = fopen ("supply_series.txt", "r");
+    if (pSeries != NULL)
+    {
+        int it;
+        double rate;
+        while ((scan = fscanf (pSeries, "%d %lf", &it, &rate)) == 2 && rate >= 0.0)
+        {
+            supply_nseries++;
+        }
+        if (scan != EOF)            // the count stopped on a bad line, not at the end of the file
+        {
+            cout << "ERROR READING supply_series.txt AT LINE " << supply_nseries + 1 << endl;
+            exit (11);
+        }
+        rewind (pSeries);
+        try {
+            supply_series_t = new int [supply_nseries];
+            supply_series_rate = new double [supply_nseries];
+        }
+        catch(...) {
+            cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+            exit (10);
+        }
+        for (int k = 0; k < supply_nseries; k++)
+        {
+            if (fscanf (pSeries, "%d %lf", &supply_series_t[k], &supply_series_rate[k]) != 2) { break; }
+            if (k > 0 && supply_series_t[k] <= supply_series_t[k - 1])
+            {
+                cout << "ERROR: supply_series.txt ITERATIONS MUST INCREASE" << endl;
+                exit (11);
+            }
+        }
+        fclose (pSeries);
+    }
+
+    cout << "Supply map: " << supply_n << " source cells, "
+        << supply_nseries << " lines in supply series" << endl;
+}
+
+double supply_rate()                // slabs per iteration at the present time
+{
+    if (supply_nseries == 0)
+    {
+        return newSandSlabs;
+    }
+    // time only runs forward, so the cursor only has to move forward
+    while (supply_cursor + 1 < supply_nseries && supply_series_t[supply_cursor + 1] <= t)
+    {
+        supply_cursor++;
+    }
+    if (supply_series_t[supply_cursor] > t)
+    {
+        return 0.0;                 // before the first line of the series
+    }
+    return supply_series_rate[supply_cursor];
+}
+
+void supplyEngine()                 // add new sand from the source map
+{
+    int slabs, n_touched, k, i, j;
+
+    if (supply_n == 0)              // allow quick exit from function if no source map
+    {
+        return;
+    }
+
+    // whole slabs this iteration, carry the fraction over
+    supply_carry = supply_carry + supply_rate();
+    slabs = (int)supply_carry;
+    supply_carry = supply_carry - slabs;
+    slabs_in = slabs_in + slabs;    // keep track of the new sand for the mass balance
+
+    // draw the source cells for the whole batch
+    n_touched = 0;
+    for (int s = 0; s < slabs; s++)
+    {
+        k = rng_int32() % supply_n;
+        if (rng_real2() >= supply_prob[k])
+        {
+            k = supply_alias[k];
+        }
+        if (supply_count[k] == 0)
+        {
+            supply_touched[n_touched] = k; n_touched++;
+        }
+        supply_count[k]++;
+    }
+
+    // place the batch, one cell at a time
+    defer_shadow = true;
+    for (int s = 0; s < n_touched; s++)
+    {
+        k = supply_touched[s];
+        i = supply_cell[k] / ncols;
+        j = supply_cell[k] % ncols;
+        while (supply_count[k] > 0)
+        {
+            add_sand(i, j);                 // add a slab
+            supply_count[k]--;
+        }
+    }
+    defer_shadow = false;
+    dirty_shadupdate();             // update the shadow wherever the new sand has touched
+}
@@ -0,0 +1,287 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Tile activity tracking: sample erosion sites from the erodible cells only
+/*
+The polling engine samples nrows * ncols random cells per iteration and most of them can not
+erode on fields with wide bare basement or shadowed interdune areas. The tile sampler keeps a
+bit for every cell that can erode (surface above basement and not in a shadow, the test in
+picksite_ero), packed 64 columns to a word, and the grid is split into tiles of 64 rows by one
+word. A Fenwick tree over the tile counts picks a tile by its number of erodible cells, the row
+within the tile is picked from the popcounts of its 64 words, and the cell from the set bits of
+the word, so every erodible cell is equally likely.
+
+Time still passes in polls: with E erodible cells out of N, the number of polls up to and including
+the next one that finds an erodible cell is geometric with p = E / N, so the sampler draws that
+number and skips straight to the successful poll. This gives the same process as the polling
+engine, just without the polls that do nothing.
+
+The bits are kept up to date wherever the surface or the shadow changes: in the avalanche
+functions (surface) and after every shadow sweep (the whole swept line). With the lazy shadow
+there are no sweeps, a change of surface rechecks the cells downwind it can shade (cell_changed).
+*/
+
+const int tile_rows = 64;           // rows per tile (a tile is one word, 64 columns, wide)
+
+// tile variables
+bool tile_mode = false;             // is the tile sampler in use
+int tile_words;                     // words per row
+int tile_ntr;                       // number of tile rows
+int tile_n;                         // number of tiles
+unsigned long long * tile_bits;     // erodible bits, nrows by tile_words
+int * tile_tree;                    // Fenwick tree over the tile counts (1 based)
+int tile_total = 0;                 // number of erodible cells
+int tile_top;                       // highest power of two not above tile_n
+char * tile_hint;                   // last paging hint given to each tile row: 0 = none, 1 = warm, 2 = cold
+
+void tile_add(int tile, int d)      // add d to the count of a tile
+{
+    tile_total = tile_total + d;
+    for (int x = tile + 1; x <= tile_n; x += x & (-x))
+    {
+        tile_tree[x] = tile_tree[x] + d;
+    }
+}
+
+int tile_prefix(int tile)           // number of erodible cells in the tiles below tile
+{
+    int n = 0;
+    for (int x = tile; x > 0; x -= x & (-x))
+    {
+        n = n + tile_tree[x];
+    }
+    return n;
+}
+
+void tile_refresh(int i, int j)     // recheck whether a cell can erode
+{
+    if (!tile_mode)                 // allow quick exit from function if the sampler is not in use
+    {
+        return;
+    }
+    unsigned long long bit = 1ULL << (j & 63);
+    unsigned long long &word = tile_bits[i * tile_words + (j >> 6)];
+    bool erodible = above_bsmt(i, j, surf[i][j]) && (surf[i][j] >= shad_at(i, j));
+    if (erodible && !(word & bit))
+    {
+        word = word | bit;
+        tile_add((i / tile_rows) * tile_words + (j >> 6), 1);
+    }
+    if (!erodible && (word & bit))
+    {
+        word = word & ~bit;
+        tile_add((i / tile_rows) * tile_words + (j >> 6), -1);
+    }
+}
+
+void tile_refresh_row(int i)        // recheck a whole row (after a shadow sweep)
+{
+    if (!tile_mode)
+    {
+        return;
+    }
+    // build each word of the row and only touch the counts where the word has changed
+    for (int w = 0; w < tile_words; w++)
+    {
+        unsigned long long word = 0;
+        int j_end = (w * 64 + 64 < ncols) ? w * 64 + 64 : ncols;
+        for (int j = w * 64; j < j_end; j++)
+        {
+            if (above_bsmt(i, j, surf[i][j]) && (surf[i][j] >= shad_at(i, j)))
+            {
+                word = word | (1ULL << (j & 63));
+            }
+        }
+        if (word != tile_bits[i * tile_words + w])
+        {
+            tile_add((i / tile_rows) * tile_words + w,
+                __builtin_popcountll (word) - __builtin_popcountll (tile_bits[i * tile_words + w]));
+            tile_bits[i * tile_words + w] = word;
+        }
+    }
+}
+
+void tile_refresh_col(int j)        // recheck a whole column (after a shadow sweep)
+{
+    if (!tile_mode)
+    {
+        return;
+    }
+    for (int i = 0; i < nrows; i++)
+    {
+        tile_refresh(i, j);
+    }
+}
+
+void tile_refresh_all()             // recheck the whole grid
+{
+    for (int i = 0; i < nrows; i++)
+    {
+        tile_refresh_row(i);
+    }
+}
+
+void init_tiles()                   // set up the tile sampler
+{
+    tile_words = (ncols + 63) / 64;
+    tile_ntr = (nrows + tile_rows - 1) / tile_rows;
+    tile_n = tile_ntr * tile_words;
+    try {
+        tile_bits = new unsigned long long [nrows * tile_words];
+        tile_tree = new int [tile_n + 1];
+        tile_hint = new char [tile_ntr];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+    for (int x = 0; x < nrows * tile_words; x++)
+    {
+        tile_bits[x] = 0;
+    }
+    for (int x = 0; x <= tile_n; x++)
+    {
+        tile_tree[x] = 0;
+    }
+    for (int b = 0; b < tile_ntr; b++)
+    {
+        tile_hint[b] = 0;
+    }
+    tile_top = 1;
+    while (tile_top * 2 <= tile_n)
+    {
+        tile_top = tile_top * 2;
+    }
+    tile_total = 0;
+    tile_mode = true;
+    tile_refresh_all();
+    cout << "Tile sampler: " << tile_n << " tiles, " << tile_total << " erodible cells" << endl;
+}
+
+int tile_skip()                     // polls up to and including the next one that finds an erodible cell
+{
+    double p = (double)tile_total / ((double)nrows * ncols);
+    if (p >= 1.0)
+    {
+        return 1;
+    }
+    double polls = 1.0 + floor (log (rng_real3()) / log (1.0 - p));
+    if (polls > (double)nrows * ncols)
+    {
+        return nrows * ncols + 1;   // past the end of the iteration in any case
+    }
+    return (int)polls;
+}
+
+void tile_pick(int &i, int &j)      // pick an erodible cell, all equally likely (tile_total > 0)
+{
+    int r = rng_int32() % tile_total;   // rank of the cell among the erodible cells
+    int tile = 0, c;
+    unsigned long long word;
+
+    // Fenwick descent to the tile holding the cell of rank r
+    for (int step = tile_top; step > 0; step = step / 2)
+    {
+        if (tile + step <= tile_n && tile_tree[tile + step] <= r)
+        {
+            tile = tile + step;
+            r = r - tile_tree[tile];
+        }
+    }
+    // then the row within the tile
+    int w = tile % tile_words;
+    i = (tile / tile_words) * tile_rows;
+    while (true)
+    {
+        c = __builtin_popcountll (tile_bits[i * tile_words + w]);
+        if (r < c)
+        {
+            break;
+        }
+        r = r - c;
+        i++;
+    }
+    // then the set bit within the word
+    word = tile_bits[i * tile_words + w];
+    for (int k = 0; k < r; k++)
+    {
+        word = word & (word - 1);   // clear the lowest set bits before the one we want
+    }
+    j = w * 64 + __builtin_ctzll (word);
+}
+
+void tile_advise()                  // paging hints for mapped grids from the tile activity, once per iteration
+{
+    if (!grid_mapped || !tile_mode)
+    {
+        return;
+    }
+    int advice, i1;
+    char state;
+    for (int b = 0; b < tile_ntr; b++)
+    {
+        state = (tile_prefix ((b + 1) * tile_words) - tile_prefix (b * tile_words) > 0) ? 1 : 2;
+        if (state == tile_hint[b])
+        {
+            continue;               // only give a hint when the tile row changes
+        }
+        tile_hint[b] = state;
+        advice = MADV_WILLNEED;
+        if (state == 2)
+        {
+#ifdef MADV_COLD
+            advice = MADV_COLD;
+#else
+            continue;               // no cold hint on this system, leave it to the kernel
+#endif
+        }
+        i1 = ((b + 1) * tile_rows < nrows) ? (b + 1) * tile_rows : nrows;
+        grid_advise_rows (surf_data, sizeof (int), b * tile_rows, i1, advice);
+        if (shadow_mode == 0)
+        {
+            grid_advise_rows (shad_data, sizeof (double), b * tile_rows, i1, advice);
+        }
+    }
+}
@@ -0,0 +1,206 @@
+/*
+wdune: This is an accessible and freely available interpretation of a cellular automata
+simulation program for sand dunes. Please note that the random number generator
+has a different license than this program, see file in this directory: 'mersenne_twister.h'.
+
+Copyright (C) 2011 Thomas E. Barchyn, Chris H. Hugenholtz
+Contact: tom.barchyn@uleth.ca, +1 (403) 332-4043
+
+License:
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+Credits:
+This program is further detailed in a accompanying publication. The code is an
+interpretation of a simulation algorithm first described in the following publication:
+
+Werner, B.T., 1995. Eolian dunes: Computer simulations and attractor interpretation.
+Geology 23, 1107-1110. DOI: 10.1130/0091-7613(1995)023<1107:EDCSAA>2.3.CO;2
+
+If you are using this program for research, we would appreciate citation of
+both papers.
+
+Notes:
+This program is written in C/C++ and has been compiled successfully with GCC 4.4.1 in
+both Windows (XP, Vista, 7) and Linux (Ubuntu 11.04). We have used the following compiler
+flags: -Wall -pedantic -O1. The program will function on some systems with higher optimization
+but we have encountered problems in some cases with -O2 and -O3.
+
+This program is designed to be called exclusively from a Python script as a long string
+of arguments need to be passed to the executable. The idea being that the Python script
+can easily be modified for batch operation, etc. Please contact Tom Barchyn for further
+assistance if you wish to extend the program (tom.barchyn@uleth.ca).
+*/
+
+// Wind schedule: time-varying wind regimes within one run
+/*
+If 'wind_schedule.txt' is present, the wind direction, deposition jump and shadow drop distance
+passed as arguments are replaced by a schedule. Each line of the schedule is one regime:
+    wind direction (1 = north, 2 = South, 3 = east, 4 = west), duration (iterations),
+    deposition jump, shadow drop distance
+The schedule is repeated from the top once the last regime is done, so a year of seasonal winds
+only needs to be written out once.
+
+The deposition lookups for every distinct direction and deposition jump are set up once at
+initialization and kept. A change of wind copies the lookups into place, resets the slablogger
+gate and rebuilds the shadow once.
+*/
+
+// wind regime
+struct wind_regime {
+    int wdir;                   // wind direction
+    int duration;               // number of iterations the regime lasts
+    int depjump;                // deposition jump
+    double dropdist;            // shadow drop distance
+    int table;                  // index of the cached deposition lookups
+};
+
+// wind schedule variables
+int wind_nregimes = 0;          // number of regimes in the schedule (0 = fixed wind)
+wind_regime * wind_sched;       // the regimes
+int wind_ntables = 0;           // number of cached lookup tables
+int * wind_i_dp;                // cached i deposition lookups, nrows per table
+int * wind_j_dp;                // cached j deposition lookups, ncols per table
+int * wind_shadloops;           // cached shadow loop counts
+int wind_now = 0;               // present regime
+int wind_next = 0;              // iteration at which the next regime starts
+
+void set_wind(int r)                // put regime r in place
+{
+    int tb = wind_sched[r].table;
+    wdir = wind_sched[r].wdir;
+    depjump = wind_sched[r].depjump;
+    dropdist = wind_sched[r].dropdist;
+    for (int i = 0; i < nrows; i++)
+    {
+        i_dp[i] = wind_i_dp[tb * nrows + i];
+    }
+    for (int j = 0; j < ncols; j++)
+    {
+        j_dp[j] = wind_j_dp[tb * ncols + j];
+    }
+    shadloops = wind_shadloops[tb];
+    set_kernels();                  // the kernels for the new wind
+}
+
+void init_wind()                    // read the wind schedule and cache the lookups
+{
+    FILE *pWind;
+    wind_regime wr;
+    int scan;
+
+    pWind = fopen ("wind_schedule.txt", "r");
+    if (pWind == NULL)              // no schedule, the wind is fixed
+    {
+        return;
+    }
+
+    // count the regimes and then read them
+    while ((scan = fscanf (pWind, "%d %d %d %lf", &wr.wdir, &wr.duration, &wr.depjump, &wr.dropdist)) == 4)
+    {
+        wind_nregimes++;
+    }
+    if (scan != EOF)                // the count stopped on a bad line, not at the end of the file
+    {
+        cout << "ERROR READING wind_schedule.txt AT LINE " << wind_nregimes + 1 << endl;
+        exit (11);
+    }
+    rewind (pWind);
+    try {
+        wind_sched = new wind_regime [wind_nregimes];
+        wind_i_dp = new int [wind_nregimes * nrows];
+        wind_j_dp = new int [wind_nregimes * ncols];
+        wind_shadloops = new int [wind_nregimes];
+    }
+    catch(...) {
+        cout << "CANNOT ALLOCATE MEMORY!!" << endl;
+        exit (10);
+    }
+
+    for (int r = 0; r < wind_nregimes; r++)
+    {
+        if (fscanf (pWind, "%d %d %d %lf", &wr.wdir, &wr.duration, &wr.depjump, &wr.dropdist) != 4) { break; }
+        if (wr.wdir < 1 || wr.wdir > 4)
+        {
+            cout << "ERROR WITH WIND DIRECTION" << endl;
+            exit (5);
+        }
+        if (wr.duration < 1)
+        {
+            cout << "ERROR: wind_schedule.txt DURATIONS MUST BE POSITIVE" << endl;
+            exit (11);
+        }
+        if (wr.depjump < 1 || wr.dropdist <= 0.0)     // as validate_params checks the fixed wind
+        {
+            cout << "ERROR: wind_schedule.txt LINE " << r + 1 << " MUST HAVE A POSITIVE depjump AND dropdist" << endl;
+            exit (11);
+        }
+
+        // look for lookups already made for this direction and deposition jump
+        wr.table = -1;
+        for (int q = 0; q < r; q++)
+        {
+            if (wind_sched[q].wdir == wr.wdir && wind_sched[q].depjump == wr.depjump)
+            {
+                wr.table = wind_sched[q].table;
+            }
+        }
+        // else make them with the boundary functions and keep a copy
+        if (wr.table == -1)
+        {
+            wr.table = wind_ntables;
+            wdir = wr.wdir;
+            depjump = wr.depjump;
+            set_bounds();
+            for (int i = 0; i < nrows; i++)
+            {
+                wind_i_dp[wr.table * nrows + i] = i_dp[i];
+            }
+            for (int j = 0; j < ncols; j++)
+            {
+                wind_j_dp[wr.table * ncols + j] = j_dp[j];
+            }
+            wind_shadloops[wr.table] = shadloops;
+            wind_ntables++;
+        }
+        wind_sched[r] = wr;
+    }
+    fclose (pWind);
+
+    if (wind_nregimes == 0)
+    {
+        cout << "ERROR: wind_schedule.txt HAS NO REGIMES" << endl;
+        exit (11);
+    }
+
+    // start with the first regime
+    wind_now = 0;
+    wind_next = wind_sched[0].duration;
+    set_wind(0);
+    cout << "Wind schedule: " << wind_nregimes << " regimes, "
+        << wind_ntables << " distinct lookup tables" << endl;
+}
+
+void wind_update()                  // change the wind at the end of a regime
+{
+    if (wind_nregimes == 0 || t < wind_next)    // allow quick exit from function
+    {
+        return;
+    }
+    wind_now = (wind_now + 1) % wind_nregimes;  // repeat the schedule from the top
+    wind_next = wind_next + wind_sched[wind_now].duration;
+    set_wind(wind_now);
+    wdune_slablogger.set_fluxes();  // the downwind gate moves with the wind
+    init_shadupdate();              // one full shadow rebuild for the new wind
+}